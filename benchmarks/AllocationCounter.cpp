@@ -0,0 +1,101 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace chatterino {
+namespace {
+    std::atomic<size_t> allocations{0};
+    thread_local size_t threadAllocations = 0;
+
+    void *allocate(size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        threadAllocations++;
+
+        // malloc(0) may return nullptr
+        if (auto pointer = std::malloc(size == 0 ? 1 : size))
+        {
+            return pointer;
+        }
+
+        throw std::bad_alloc();
+    }
+}  // namespace
+
+size_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+size_t threadAllocationCount()
+{
+    return threadAllocations;
+}
+
+}  // namespace chatterino
+
+void *operator new(size_t size)
+{
+    return chatterino::allocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return chatterino::allocate(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return chatterino::allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return chatterino::allocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace chatterino {
+
+// The benchmarks replace the global operator new to count allocations. The
+// counts only ever go up, take the difference of two calls.
+
+// allocations made by all threads
+size_t allocationCount();
+
+// allocations made by the calling thread
+size_t threadAllocationCount();
+
+}  // namespace chatterino
@@ -0,0 +1,257 @@
+#include "ReplayBenchmark.hpp"
+
+#include "AllocationCounter.hpp"
+#include "Application.hpp"
+#include "StubNetworkRequest.hpp"
+#include "common/Channel.hpp"
+#include "messages/Message.hpp"
+#include "messages/MessageBuildQueue.hpp"
+#include "messages/Selection.hpp"
+#include "messages/layouts/MessageBufferAtlas.hpp"
+#include "messages/layouts/MessageLayout.hpp"
+#include "providers/twitch/IrcMessageHandler.hpp"
+#include "providers/twitch/TwitchServer.hpp"
+#include "singletons/WindowManager.hpp"
+#include "util/QStringHash.hpp"
+
+#include <IrcMessage>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPainter>
+#include <QPixmap>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+namespace {
+    const int viewWidth = 500;
+    const int viewHeight = 1000;
+
+    struct Stage {
+        QString name;
+        std::vector<qint64> samples;
+        size_t allocations = 0;
+
+        // measures the time and the allocations of the gui thread
+        template <typename F>
+        void run(F &&function)
+        {
+            auto allocationsBefore = threadAllocationCount();
+            QElapsedTimer timer;
+            timer.start();
+
+            function();
+
+            this->samples.push_back(timer.nsecsElapsed());
+            this->allocations += threadAllocationCount() - allocationsBefore;
+        }
+    };
+
+    double percentile(const std::vector<qint64> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        auto index = size_t(p * double(sorted.size() - 1));
+
+        return double(sorted[index]) / 1000.0;
+    }
+
+    QString formatStage(Stage &stage)
+    {
+        auto &samples = stage.samples;
+        std::sort(samples.begin(), samples.end());
+
+        auto allocations =
+            samples.empty() ? 0.0
+                            : double(stage.allocations) / samples.size();
+
+        return QString("%1: p50 %2 us, p90 %3 us, p99 %4 us, max %5 us, "
+                       "%6 allocations")
+            .arg(stage.name)
+            .arg(percentile(samples, 0.5), 0, 'f', 1)
+            .arg(percentile(samples, 0.9), 0, 'f', 1)
+            .arg(percentile(samples, 0.99), 0, 'f', 1)
+            .arg(percentile(samples, 1), 0, 'f', 1)
+            .arg(allocations, 0, 'f', 1);
+    }
+
+    // the commands the read connection hands to IrcMessageHandler, see
+    // TwitchServer::messageReceived
+    void handle(Communi::IrcMessage *message, TwitchServer &server)
+    {
+        auto &handler = IrcMessageHandler::getInstance();
+        auto command = message->command();
+
+        if (command == "PRIVMSG")
+            handler.handlePrivMessage(
+                static_cast<Communi::IrcPrivateMessage *>(message), server);
+        else if (command == "USERNOTICE")
+            handler.handleUserNoticeMessage(message, server);
+        else if (command == "ROOMSTATE")
+            handler.handleRoomStateMessage(message);
+        else if (command == "CLEARCHAT")
+            handler.handleClearChatMessage(message);
+        else if (command == "USERSTATE")
+            handler.handleUserStateMessage(message);
+        else if (command == "WHISPER")
+            handler.handleWhisperMessage(message);
+        else if (command == "NOTICE")
+            handler.handleNoticeMessage(
+                static_cast<Communi::IrcNoticeMessage *>(message));
+        else if (command == "MODE")
+            handler.handleModeMessage(message);
+        else if (command == "JOIN")
+            handler.handleJoinMessage(message);
+        else if (command == "PART")
+            handler.handlePartMessage(message);
+    }
+}  // namespace
+
+QString replayBenchmark(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return "Could not open " + path;
+    }
+
+    std::vector<QByteArray> lines;
+    while (!file.atEnd())
+    {
+        auto line = file.readLine().trimmed();
+
+        if (!line.isEmpty())
+            lines.push_back(line);
+    }
+
+    auto &server = *getApp()->twitch.server;
+
+    // join the channels of the recording before it starts, their emotes and
+    // badges come from the fixtures
+    std::vector<ChannelPtr> channels;
+    for (const auto &line : lines)
+    {
+        std::unique_ptr<Communi::IrcMessage> message(
+            Communi::IrcMessage::fromData(line, nullptr));
+        auto target = message->parameters().value(0);
+
+        if (target.startsWith('#') &&
+            server.getChannelOrEmpty(target.mid(1))->isEmpty())
+        {
+            channels.push_back(server.getOrAddChannel(target.mid(1)));
+        }
+    }
+    waitForNetworkReplies();
+
+    MessageBufferAtlas atlas;
+    QPixmap view(viewWidth, viewHeight);
+    Selection selection;
+    auto flags = getApp()->windows->getWordFlags();
+
+    Stage parseStage{"parse", {}};
+    Stage handleStage{"handle", {}};
+    Stage buildStage{"handle to channel", {}};
+    Stage layoutStage{"layout", {}};
+    Stage paintStage{"paint", {}};
+
+    size_t count = 0;
+    QElapsedTimer total;
+
+    // when the messages were handed to IrcMessageHandler, by id
+    std::unordered_map<QString, qint64> handledAt;
+
+    std::vector<pajlada::Signals::ScopedConnection> connections;
+    for (const auto &channel : channels)
+    {
+        connections.push_back(channel->messageAppended.connect(
+            [&](MessagePtr &message, auto) {
+                auto it = handledAt.find(message->id);
+                if (it != handledAt.end())
+                {
+                    buildStage.samples.push_back(total.nsecsElapsed() -
+                                                 it->second);
+                    handledAt.erase(it);
+                }
+
+                MessageLayout layout(message);
+                layoutStage.run(
+                    [&] { layout.layout(viewWidth, 1, flags); });
+
+                paintStage.run([&] {
+                    atlas.beginFrame(viewWidth, viewHeight, 1);
+
+                    QPainter painter(&view);
+                    layout.paint(painter, atlas, viewWidth, 0, 0, selection,
+                                 false, true);
+                });
+
+                count++;
+            }));
+    }
+
+    auto allocationsBefore = allocationCount();
+    total.start();
+
+    for (const auto &line : lines)
+    {
+        std::unique_ptr<Communi::IrcMessage> message;
+        parseStage.run([&] {
+            message.reset(Communi::IrcMessage::fromData(line, nullptr));
+        });
+
+        auto id = message->tags().value("id").toString();
+        if (!id.isEmpty())
+        {
+            handledAt[id] = total.nsecsElapsed();
+        }
+
+        handleStage.run([&] { handle(message.get(), server); });
+
+        // finished builds, fixture replies and channel updates are handled
+        // between lines, like the event loop would
+        QCoreApplication::processEvents();
+    }
+
+    // wait for the builds that are still running
+    bool finished = false;
+    MessageBuildQueue::getInstance().runAfterPending(
+        [&] { finished = true; });
+    while (!finished)
+    {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    for (const auto &channel : channels)
+    {
+        channel->flushAppendedMessages();
+    }
+
+    auto elapsed = std::max<qint64>(1, total.elapsed());
+    auto allocations = allocationCount() - allocationsBefore;
+
+    connections.clear();
+    waitForNetworkReplies();
+
+    QString report =
+        QString("Replayed %1 messages from %2 lines in %3 ms, "
+                "%4 messages/s, %5 allocations per message on all threads")
+            .arg(count)
+            .arg(lines.size())
+            .arg(elapsed)
+            .arg(qint64(count * 1000 / elapsed))
+            .arg(count == 0 ? 0.0 : double(allocations) / count, 0, 'f', 1);
+
+    for (auto stage :
+         {&parseStage, &handleStage, &buildStage, &layoutStage, &paintStage})
+    {
+        report += "\n" + formatStage(*stage);
+    }
+
+    return report;
+}
+
+}  // namespace chatterino
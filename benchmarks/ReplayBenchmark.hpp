@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QString>
+
+namespace chatterino {
+
+// Replays recorded irc traffic through the message pipeline and returns a
+// report with the throughput, the latency of every stage and the
+// allocations per message.
+//
+// The file contains one raw irc line per line, e.g. what the irc connection
+// received. The lines are parsed and handed to IrcMessageHandler like the
+// read connection does, for channels that were joined on the TwitchServer
+// beforehand. The messages that get added to the channels are laid out and
+// painted into an offscreen pixmap.
+QString replayBenchmark(const QString &path);
+
+}  // namespace chatterino
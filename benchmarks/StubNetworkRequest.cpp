@@ -0,0 +1,230 @@
+#include "StubNetworkRequest.hpp"
+
+#include "common/NetworkData.hpp"
+#include "common/NetworkRequest.hpp"
+#include "common/Outcome.hpp"
+#include "debug/Log.hpp"
+#include "providers/twitch/TwitchCommon.hpp"
+#include "util/DebugCount.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <atomic>
+
+namespace chatterino {
+namespace {
+    // filled before the first request, only read afterwards
+    QHash<QString, QByteArray> fixtures;
+
+    std::atomic<int> pendingReplies{0};
+}  // namespace
+
+void loadNetworkFixtures(const QString &directory)
+{
+    QDir dir(directory);
+    QFile urls(dir.filePath("urls.txt"));
+    if (!urls.open(QIODevice::ReadOnly))
+    {
+        log("[Benchmark] Could not open {}", urls.fileName());
+        return;
+    }
+
+    while (!urls.atEnd())
+    {
+        auto line = QString::fromUtf8(urls.readLine()).trimmed();
+        auto parts = line.split(' ', QString::SkipEmptyParts);
+
+        if (parts.size() != 2 || line.startsWith('#'))
+            continue;
+
+        QFile file(dir.filePath(parts[1]));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            log("[Benchmark] Could not open {}", file.fileName());
+            continue;
+        }
+
+        fixtures[parts[0]] = file.readAll();
+    }
+}
+
+void waitForNetworkReplies()
+{
+    while (pendingReplies > 0)
+    {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+
+    // answers that are handled concurrently
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+NetworkRequest::NetworkRequest(const std::string &url,
+                               NetworkRequestType requestType)
+    : data(new NetworkData)
+    , timer(new NetworkTimer)
+{
+    this->data->request_.setUrl(QUrl(QString::fromStdString(url)));
+    this->data->requestType_ = requestType;
+}
+
+NetworkRequest::NetworkRequest(QUrl url, NetworkRequestType requestType)
+    : data(new NetworkData)
+    , timer(new NetworkTimer)
+{
+    this->data->request_.setUrl(url);
+    this->data->requestType_ = requestType;
+}
+
+NetworkRequest::~NetworkRequest()
+{
+}
+
+void NetworkRequest::setRequestType(NetworkRequestType newRequestType)
+{
+    this->data->requestType_ = newRequestType;
+}
+
+void NetworkRequest::setCaller(const QObject *caller)
+{
+    this->data->caller_ = caller;
+}
+
+void NetworkRequest::onReplyCreated(NetworkReplyCreatedCallback cb)
+{
+    this->data->onReplyCreated_ = cb;
+}
+
+void NetworkRequest::onError(NetworkErrorCallback cb)
+{
+    this->data->onError_ = cb;
+}
+
+void NetworkRequest::onSuccess(NetworkSuccessCallback cb)
+{
+    this->data->onSuccess_ = cb;
+}
+
+void NetworkRequest::setRawHeader(const char *headerName, const char *value)
+{
+    this->data->request_.setRawHeader(headerName, value);
+}
+
+void NetworkRequest::setRawHeader(const char *headerName,
+                                  const QByteArray &value)
+{
+    this->data->request_.setRawHeader(headerName, value);
+}
+
+void NetworkRequest::setRawHeader(const char *headerName, const QString &value)
+{
+    this->data->request_.setRawHeader(headerName, value.toUtf8());
+}
+
+void NetworkRequest::setTimeout(int ms)
+{
+    this->timer->timeoutMS_ = ms;
+}
+
+void NetworkRequest::setExecuteConcurrently(bool value)
+{
+    this->data->executeConcurrently = value;
+}
+
+void NetworkRequest::makeAuthorizedV5(const QString &clientID,
+                                      const QString &oauthToken)
+{
+    this->setRawHeader("Client-ID", clientID);
+    this->setRawHeader("Accept", "application/vnd.twitchtv.v5+json");
+    if (!oauthToken.isEmpty())
+    {
+        this->setRawHeader("Authorization", "OAuth " + oauthToken);
+    }
+}
+
+void NetworkRequest::setPayload(const QByteArray &payload)
+{
+    this->data->payload_ = payload;
+}
+
+void NetworkRequest::setPriority(NetworkRequestPriority priority)
+{
+    this->data->priority_ = priority;
+}
+
+void NetworkRequest::setUseQuickLoadCache(bool value)
+{
+    this->data->useQuickLoadCache_ = value;
+}
+
+void NetworkRequest::execute()
+{
+    this->executed_ = true;
+
+    auto data = this->data;
+    auto it = fixtures.find(this->urlString());
+    bool found = it != fixtures.end();
+    auto bytes = found ? it.value() : QByteArray();
+
+    DebugCount::increase(found ? "http request fixture"
+                               : "http request without fixture");
+
+    bool hasCaller = data->caller_ != nullptr;
+    QPointer<QObject> caller(const_cast<QObject *>(data->caller_));
+
+    // answered once control returns to the event loop, like a real reply
+    pendingReplies++;
+    postToThread([data, found, bytes, hasCaller, caller]() mutable {
+        pendingReplies--;
+
+        if (hasCaller && caller.isNull())
+        {
+            return;
+        }
+
+        if (!found)
+        {
+            if (data->onError_)
+            {
+                data->onError_(QNetworkReply::ContentNotFoundError);
+            }
+            return;
+        }
+
+        if (data->onSuccess_)
+        {
+            if (data->executeConcurrently)
+                QtConcurrent::run(
+                    [onSuccess = std::move(data->onSuccess_),
+                     bytes = std::move(bytes)]() mutable {
+                        onSuccess(NetworkResult(std::move(bytes)));
+                    });
+            else
+                data->onSuccess_(NetworkResult(std::move(bytes)));
+        }
+    });
+}
+
+QString NetworkRequest::urlString() const
+{
+    return this->data->request_.url().toString();
+}
+
+// Helper creator functions
+NetworkRequest NetworkRequest::twitchRequest(QUrl url)
+{
+    NetworkRequest request(url);
+
+    request.makeAuthorizedV5(getDefaultClientID());
+
+    return request;
+}
+
+}  // namespace chatterino
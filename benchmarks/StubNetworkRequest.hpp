@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QString>
+
+namespace chatterino {
+
+// The benchmarks are linked against StubNetworkRequest.cpp instead of the
+// real NetworkRequest.cpp, so no request leaves the process and the disk
+// cache isn't used. Requests for urls that have a fixture succeed with its
+// contents, all others fail. The answers are delivered on the gui thread.
+
+// reads "<directory>/urls.txt", one "<url> <file>" per line with the file
+// relative to the directory
+void loadNetworkFixtures(const QString &directory);
+
+// processes events until every request that was executed got its answer
+void waitForNetworkReplies();
+
+}  // namespace chatterino
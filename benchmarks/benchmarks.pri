@@ -0,0 +1,24 @@
+# Builds chatterino-benchmarks instead of the app, see benchmarks/README.md.
+# The entry point and the network requests of the app are replaced.
+
+TARGET = chatterino-benchmarks
+equals(QMAKE_CXX, "clang++")|equals(QMAKE_CXX, "g++") {
+    TARGET = bin/chatterino-benchmarks
+}
+
+INCLUDEPATH += $$PWD
+
+SOURCES -= \
+    src/main.cpp \
+    src/common/NetworkRequest.cpp
+
+SOURCES += \
+    $$PWD/AllocationCounter.cpp \
+    $$PWD/main.cpp \
+    $$PWD/ReplayBenchmark.cpp \
+    $$PWD/StubNetworkRequest.cpp
+
+HEADERS += \
+    $$PWD/AllocationCounter.hpp \
+    $$PWD/ReplayBenchmark.hpp \
+    $$PWD/StubNetworkRequest.hpp
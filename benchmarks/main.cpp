@@ -0,0 +1,51 @@
+#include "Application.hpp"
+#include "ReplayBenchmark.hpp"
+#include "StubNetworkRequest.hpp"
+#include "singletons/Paths.hpp"
+#include "singletons/Settings.hpp"
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+#include <iostream>
+
+using namespace chatterino;
+
+// chatterino-benchmarks <recorded irc lines> [<fixtures directory>]
+int main(int argc, char **argv)
+{
+    QApplication a(argc, argv);
+
+    auto args = a.arguments();
+    if (args.size() < 2)
+    {
+        std::cerr << "Usage: chatterino-benchmarks <recorded irc lines> "
+                     "[<fixtures directory>]"
+                  << std::endl;
+        return 1;
+    }
+
+    // run in portable mode, so the settings and caches are kept next to the
+    // executable and every run starts with the same ones
+    QFile(QDir(QCoreApplication::applicationDirPath()).filePath("portable"))
+        .open(QIODevice::WriteOnly);
+
+    // the emotes and badges are requested while the app is initialized
+    if (args.size() > 2)
+    {
+        loadNetworkFixtures(args[2]);
+    }
+
+    Paths paths;
+    Settings settings(paths);
+
+    Application app(settings, paths);
+    app.initialize(settings, paths);
+    waitForNetworkReplies();
+
+    std::cout << replayBenchmark(args[1]).toStdString() << std::endl;
+
+    return 0;
+}
@@ -110,12 +110,16 @@ werr {
 SOURCES += \
     src/Application.cpp \
     src/common/Channel.cpp \
+    src/common/ChannelSearchIndex.cpp \
     src/common/CompletionModel.cpp \
+    src/common/NetworkCache.cpp \
     src/common/NetworkData.cpp \
     src/common/NetworkManager.cpp \
     src/common/NetworkRequest.cpp \
     src/common/NetworkResult.cpp \
+    src/common/NetworkScheduler.cpp \
     src/common/NetworkTimer.cpp \
+    src/common/PrefixIndex.cpp \
     src/controllers/accounts/Account.cpp \
     src/controllers/accounts/AccountController.cpp \
     src/controllers/accounts/AccountModel.cpp \
@@ -123,6 +127,7 @@ SOURCES += \
     src/controllers/commands/CommandController.cpp \
     src/controllers/commands/CommandModel.cpp \
     src/controllers/highlights/HighlightController.cpp \
+    src/controllers/highlights/HighlightMatcher.cpp \
     src/controllers/highlights/HighlightModel.cpp \
     src/controllers/highlights/HighlightBlacklistModel.cpp \
     src/controllers/highlights/UserHighlightModel.cpp \
@@ -134,12 +139,15 @@ SOURCES += \
     src/controllers/taggedusers/TaggedUsersModel.cpp \
     src/main.cpp \
     src/messages/Image.cpp \
+    src/messages/ImageDecodeQueue.cpp \
+    src/messages/layouts/MessageBufferAtlas.cpp \
     src/messages/layouts/MessageLayout.cpp \
     src/messages/layouts/MessageLayoutContainer.cpp \
     src/messages/layouts/MessageLayoutElement.cpp \
     src/messages/Link.cpp \
     src/messages/Message.cpp \
     src/messages/MessageBuilder.cpp \
+    src/messages/MessageBuildQueue.cpp \
     src/messages/MessageColor.cpp \
     src/messages/MessageElement.cpp \
     src/providers/emoji/Emojis.cpp \
@@ -157,17 +165,21 @@ SOURCES += \
     src/providers/twitch/TwitchChannel.cpp \
     src/providers/twitch/TwitchEmotes.cpp \
     src/providers/twitch/TwitchHelpers.cpp \
+    src/providers/twitch/TwitchIrcLine.cpp \
     src/providers/twitch/TwitchMessageBuilder.cpp \
     src/providers/twitch/TwitchServer.cpp \
     src/providers/twitch/TwitchUser.cpp \
     src/common/ChatterinoSetting.cpp \
     src/singletons/helper/GifTimer.cpp \
+    src/singletons/helper/LogIndex.cpp \
     src/singletons/helper/LoggingChannel.cpp \
     src/controllers/moderationactions/ModerationAction.cpp \
     src/singletons/WindowManager.cpp \
     src/util/DebugCount.cpp \
+    src/util/PhraseAutomaton.cpp \
     src/util/RapidjsonHelpers.cpp \
     src/util/StreamLink.cpp \
+    src/util/StringInterner.cpp \
     src/util/WindowsHelper.cpp \
     src/widgets/AccountSwitchPopupWidget.cpp \
     src/widgets/AccountSwitchWidget.cpp \
@@ -274,17 +286,20 @@ SOURCES += \
 HEADERS  += \
     src/Application.hpp \
     src/common/Channel.hpp \
+    src/common/ChannelSearchIndex.hpp \
     src/common/Common.hpp \
     src/common/CompletionModel.hpp \
     src/common/FlagsEnum.hpp \
     src/common/Atomic.hpp \
     src/common/NetworkCommon.hpp \
+    src/common/NetworkCache.hpp \
     src/common/NetworkData.hpp \
     src/common/NetworkManager.hpp \
     src/common/NetworkRequest.hpp \
-    src/common/NetworkRequester.hpp \
     src/common/NetworkResult.hpp \
+    src/common/NetworkScheduler.hpp \
     src/common/NetworkTimer.hpp \
+    src/common/PrefixIndex.hpp \
     src/common/NetworkWorker.hpp \
     src/common/NullablePtr.hpp \
     src/common/ProviderId.hpp \
@@ -298,6 +313,7 @@ HEADERS  += \
     src/controllers/commands/CommandController.hpp \
     src/controllers/commands/CommandModel.hpp \
     src/controllers/highlights/HighlightController.hpp \
+    src/controllers/highlights/HighlightMatcher.hpp \
     src/controllers/highlights/HighlightModel.hpp \
     src/controllers/highlights/HighlightBlacklistModel.hpp \
     src/controllers/highlights/HighlightPhrase.hpp \
@@ -314,6 +330,8 @@ HEADERS  += \
     src/debug/Benchmark.hpp \
     src/debug/Log.hpp \
     src/messages/Image.hpp \
+    src/messages/ImageDecodeQueue.hpp \
+    src/messages/layouts/MessageBufferAtlas.hpp \
     src/messages/layouts/MessageLayout.hpp \
     src/messages/layouts/MessageLayoutContainer.hpp \
     src/messages/layouts/MessageLayoutElement.hpp \
@@ -322,6 +340,7 @@ HEADERS  += \
     src/messages/Link.hpp \
     src/messages/Message.hpp \
     src/messages/MessageBuilder.hpp \
+    src/messages/MessageBuildQueue.hpp \
     src/messages/MessageColor.hpp \
     src/messages/MessageElement.hpp \
     src/messages/Selection.hpp \
@@ -342,11 +361,13 @@ HEADERS  += \
     src/providers/twitch/TwitchChannel.hpp \
     src/providers/twitch/TwitchEmotes.hpp \
     src/providers/twitch/TwitchHelpers.hpp \
+    src/providers/twitch/TwitchIrcLine.hpp \
     src/providers/twitch/TwitchMessageBuilder.hpp \
     src/providers/twitch/TwitchServer.hpp \
     src/providers/twitch/TwitchUser.hpp \
     src/common/ChatterinoSetting.hpp \
     src/singletons/helper/GifTimer.hpp \
+    src/singletons/helper/LogIndex.hpp \
     src/singletons/helper/LoggingChannel.hpp \
     src/controllers/moderationactions/ModerationAction.hpp \
     src/singletons/WindowManager.hpp \
@@ -358,13 +379,16 @@ HEADERS  += \
     src/util/Helpers.hpp \
     src/util/IrcHelpers.hpp \
     src/util/LayoutCreator.hpp \
+    src/util/PhraseAutomaton.hpp \
     src/util/PostToThread.hpp \
     src/util/QStringHash.hpp \
     src/util/RapidjsonHelpers.hpp \
     src/util/RemoveScrollAreaBackground.hpp \
     src/util/SharedPtrElementLess.hpp \
+    src/util/SpscQueue.hpp \
     src/util/StandardItemHelper.hpp \
     src/util/StreamLink.hpp \
+    src/util/StringInterner.hpp \
     src/util/WindowsHelper.hpp \
     src/widgets/AccountSwitchPopupWidget.hpp \
     src/widgets/AccountSwitchWidget.hpp \
@@ -458,6 +482,7 @@ HEADERS  += \
     src/providers/twitch/TwitchParseCheerEmotes.hpp \
     src/providers/bttv/LoadBttvChannelEmote.hpp \
     src/util/JsonQuery.hpp \
+    src/util/JsonSaxHandler.hpp \
     src/RunGui.hpp \
     src/BrowserExtension.hpp \
     src/util/FormatTime.hpp \
@@ -538,3 +563,8 @@ win32-msvc* {
 linux {
     QMAKE_LFLAGS += -lrt
 }
+
+# Benchmarks, "qmake CONFIG+=benchmarks" builds them instead of the app
+benchmarks {
+    include(benchmarks/benchmarks.pri)
+}
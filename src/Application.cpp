@@ -25,7 +25,6 @@
 #include "singletons/Toasts.hpp"
 #include "singletons/WindowManager.hpp"
 #include "util/IsBigEndian.hpp"
-#include "util/PostToThread.hpp"
 #include "widgets/Window.hpp"
 
 #include <atomic>
@@ -146,7 +145,7 @@ void Application::initPubsub()
                 QString("%1 cleared the chat").arg(action.source.name);
 
             auto msg = makeSystemMessage(text);
-            postToThread([chan, msg] { chan->addMessage(msg); });
+            chan->addMessage(msg);
         });
 
     this->twitch.pubsub->signals_.moderation.modeChanged.connect(
@@ -172,7 +171,7 @@ void Application::initPubsub()
             }
 
             auto msg = makeSystemMessage(text);
-            postToThread([chan, msg] { chan->addMessage(msg); });
+            chan->addMessage(msg);
         });
 
     this->twitch.pubsub->signals_.moderation.moderationStateChanged.connect(
@@ -198,7 +197,7 @@ void Application::initPubsub()
             }
 
             auto msg = makeSystemMessage(text);
-            postToThread([chan, msg] { chan->addMessage(msg); });
+            chan->addMessage(msg);
         });
 
     this->twitch.pubsub->signals_.moderation.userBanned.connect(
@@ -214,9 +213,7 @@ void Application::initPubsub()
             MessageBuilder msg(action);
             msg->flags.set(MessageFlag::PubSub);
 
-            postToThread([chan, msg = msg.release()] {
-                chan->addOrReplaceTimeout(msg);
-            });
+            chan->addOrReplaceTimeout(msg.release());
         });
 
     this->twitch.pubsub->signals_.moderation.userUnbanned.connect(
@@ -231,7 +228,7 @@ void Application::initPubsub()
 
             auto msg = MessageBuilder(action).release();
 
-            postToThread([chan, msg] { chan->addMessage(msg); });
+            chan->addMessage(msg);
         });
 
     this->twitch.pubsub->start();
@@ -6,6 +6,7 @@
 #include <QStyleFactory>
 
 #include "Application.hpp"
+#include "common/NetworkCache.hpp"
 #include "common/NetworkManager.hpp"
 #include "singletons/Paths.hpp"
 #include "singletons/Updates.hpp"
@@ -143,6 +144,7 @@ void runGui(QApplication &a, Paths &paths, Settings &settings)
     pajlada::Settings::SettingManager::gSave();
 
     chatterino::NetworkManager::deinit();
+    chatterino::NetworkCache::getInstance().flush();
 
 #ifdef USEWINSDK
     // flushing windows clipboard to keep copied messages
@@ -1,6 +1,7 @@
 #include "common/Channel.hpp"
 
 #include "Application.hpp"
+#include "common/ChannelSearchIndex.hpp"
 #include "debug/Log.hpp"
 #include "messages/Message.hpp"
 #include "messages/MessageBuilder.hpp"
@@ -26,6 +27,10 @@ Channel::Channel(const QString &name, Type type)
     , name_(name)
     , type_(type)
 {
+    this->appendTimer_.setSingleShot(true);
+    this->appendTimer_.setInterval(0);
+    QObject::connect(&this->appendTimer_, &QTimer::timeout,
+                     [this] { this->flushAppendedMessages(); });
 }
 
 Channel::~Channel()
@@ -77,12 +82,77 @@ void Channel::addMessage(MessagePtr message,
         app->logging->addMessage(this->name_, message);
     }
 
+    // messages with overriding flags go out on their own, everything else is
+    // batched up until the event loop runs again
+    if (overridingFlags)
+    {
+        this->flushAppendedMessages();
+
+        if (this->messages_.pushBack(message, deleted))
+        {
+            if (auto index = this->searchIndex_.lock())
+            {
+                index->removeMessage(deleted);
+            }
+
+            this->messageRemovedFromStart.invoke(deleted);
+        }
+
+        if (auto index = this->searchIndex_.lock())
+        {
+            index->addMessages({message});
+        }
+
+        this->messageAppended.invoke(message, overridingFlags);
+        return;
+    }
+
     if (this->messages_.pushBack(message, deleted))
     {
-        this->messageRemovedFromStart.invoke(deleted);
+        this->pendingRemoved_.push_back(std::move(deleted));
     }
 
-    this->messageAppended.invoke(message, overridingFlags);
+    this->pendingAppended_.push_back(std::move(message));
+
+    if (!this->appendTimer_.isActive())
+    {
+        this->appendTimer_.start();
+    }
+}
+
+void Channel::flushAppendedMessages()
+{
+    this->appendTimer_.stop();
+
+    if (this->pendingAppended_.empty())
+    {
+        return;
+    }
+
+    // swap first, the signal handlers might add messages themselves
+    std::vector<MessagePtr> removed;
+    std::vector<MessagePtr> appended;
+    removed.swap(this->pendingRemoved_);
+    appended.swap(this->pendingAppended_);
+
+    if (auto index = this->searchIndex_.lock())
+    {
+        // add first, a big batch can evict messages that were appended in
+        // the same batch
+        index->addMessages(appended);
+
+        for (auto &message : removed)
+        {
+            index->removeMessage(message);
+        }
+    }
+
+    for (auto &message : removed)
+    {
+        this->messageRemovedFromStart.invoke(message);
+    }
+
+    this->messagesAppended.invoke(appended);
 }
 
 void Channel::addOrReplaceTimeout(MessagePtr message)
@@ -185,25 +255,67 @@ void Channel::disableAllMessages()
 
 void Channel::addMessagesAtStart(std::vector<MessagePtr> &_messages)
 {
+    this->flushAppendedMessages();
+
     std::vector<MessagePtr> addedMessages =
         this->messages_.pushFront(_messages);
 
     if (addedMessages.size() != 0)
     {
+        if (auto index = this->searchIndex_.lock())
+        {
+            index->addMessagesAtStart(addedMessages);
+        }
+
         this->messagesAddedAtStart.invoke(addedMessages);
     }
 }
 
 void Channel::replaceMessage(MessagePtr message, MessagePtr replacement)
 {
+    // listeners index into their own copy of the messages, so it has to be up
+    // to date
+    this->flushAppendedMessages();
+
     int index = this->messages_.replaceItem(message, replacement);
 
     if (index >= 0)
     {
+        if (auto searchIndex = this->searchIndex_.lock())
+        {
+            searchIndex->replaceMessage(size_t(index), replacement);
+        }
+
         this->messageReplaced.invoke((size_t)index, replacement);
     }
 }
 
+std::shared_ptr<ChannelSearchIndex> Channel::getSearchIndex()
+{
+    auto index = this->searchIndex_.lock();
+
+    if (!index)
+    {
+        // pending messages are already in the queue, they would be added twice
+        this->flushAppendedMessages();
+
+        index = std::make_shared<ChannelSearchIndex>();
+        auto snapshot = this->getMessageSnapshot();
+
+        std::vector<MessagePtr> messages;
+        messages.reserve(snapshot.getLength());
+        for (size_t i = 0; i < snapshot.getLength(); i++)
+        {
+            messages.push_back(snapshot[i]);
+        }
+
+        index->addMessages(messages);
+        this->searchIndex_ = index;
+    }
+
+    return index;
+}
+
 void Channel::addRecentChatter(const MessagePtr &message)
 {
 }
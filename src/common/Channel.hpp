@@ -10,6 +10,7 @@
 #include <pajlada/signals/signal.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace chatterino {
 
@@ -18,6 +19,8 @@ using MessagePtr = std::shared_ptr<const Message>;
 enum class MessageFlag : uint16_t;
 using MessageFlags = FlagsEnum<MessageFlag>;
 
+class ChannelSearchIndex;
+
 class Channel : public std::enable_shared_from_this<Channel>
 {
 public:
@@ -41,6 +44,9 @@ public:
     pajlada::Signals::Signal<MessagePtr &> messageRemovedFromStart;
     pajlada::Signals::Signal<MessagePtr &, boost::optional<MessageFlags>>
         messageAppended;
+    // messages added with addMessage are collected and handed out in one go
+    // once control returns to the event loop
+    pajlada::Signals::Signal<std::vector<MessagePtr> &> messagesAppended;
     pajlada::Signals::Signal<std::vector<MessagePtr> &> messagesAddedAtStart;
     pajlada::Signals::Signal<size_t, MessagePtr &> messageReplaced;
     pajlada::Signals::NoArgSignal destroyed;
@@ -62,6 +68,14 @@ public:
     void disableAllMessages();
     void replaceMessage(MessagePtr message, MessagePtr replacement);
 
+    // invokes messagesAppended for messages that were added but not announced
+    // yet
+    void flushAppendedMessages();
+
+    // The index is created on first use and kept up to date for as long as
+    // someone holds on to it.
+    std::shared_ptr<ChannelSearchIndex> getSearchIndex();
+
     QStringList modList;
 
     virtual bool canSendMessage() const;
@@ -85,6 +99,13 @@ private:
     LimitedQueue<MessagePtr> messages_;
     Type type_;
     QTimer clearCompletionModelTimer_;
+
+    QTimer appendTimer_;
+    std::vector<MessagePtr> pendingAppended_;
+    std::vector<MessagePtr> pendingRemoved_;
+
+    // only kept up to date while a search popup holds on to it
+    std::weak_ptr<ChannelSearchIndex> searchIndex_;
 };
 
 using ChannelPtr = std::shared_ptr<Channel>;
@@ -0,0 +1,283 @@
+#include "common/ChannelSearchIndex.hpp"
+
+#include "messages/Link.hpp"
+#include "messages/Message.hpp"
+#include "messages/MessageElement.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace chatterino {
+namespace {
+    // matches are handed out in batches of this size
+    const size_t batchSize = 100;
+
+    template <typename F>
+    void forEachTrigram(const QString &text, F &&f)
+    {
+        auto lower = text.toLower();
+
+        for (int i = 0; i + 2 < lower.size(); i++)
+        {
+            f(uint64_t(lower[i].unicode()) |
+              uint64_t(lower[i + 1].unicode()) << 16 |
+              uint64_t(lower[i + 2].unicode()) << 32);
+        }
+    }
+
+    bool hasLink(const Message &message)
+    {
+        for (const auto &element : message.elements)
+        {
+            if (element->getLink().type == Link::Url)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void intersect(std::vector<int64_t> &ids, const std::set<int64_t> &other)
+    {
+        std::vector<int64_t> result;
+        std::set_intersection(ids.begin(), ids.end(), other.begin(),
+                              other.end(), std::back_inserter(result));
+        ids.swap(result);
+    }
+}  // namespace
+
+ChannelSearchIndex::Query ChannelSearchIndex::parseQuery(const QString &text)
+{
+    Query query;
+    QStringList words;
+
+    for (const auto &word : text.split(' ', QString::SkipEmptyParts))
+    {
+        if (word.startsWith("from:", Qt::CaseInsensitive) && word.size() > 5)
+        {
+            query.fromUsers.push_back(word.mid(5).toLower());
+        }
+        else if (word.compare("has:link", Qt::CaseInsensitive) == 0)
+        {
+            query.hasLink = true;
+        }
+        else if (word.compare("is:highlighted", Qt::CaseInsensitive) == 0)
+        {
+            query.isHighlighted = true;
+        }
+        else
+        {
+            words.push_back(word);
+        }
+    }
+
+    query.text = words.join(' ');
+
+    return query;
+}
+
+void ChannelSearchIndex::addMessages(const std::vector<MessagePtr> &messages)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    for (const auto &message : messages)
+    {
+        this->add(this->nextId_++, message);
+    }
+}
+
+void ChannelSearchIndex::addMessagesAtStart(
+    const std::vector<MessagePtr> &messages)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    for (auto it = messages.rbegin(); it != messages.rend(); it++)
+    {
+        this->add(this->nextIdAtStart_--, *it);
+    }
+}
+
+void ChannelSearchIndex::removeMessage(const MessagePtr &message)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    auto it = this->ids_.find(message.get());
+    if (it != this->ids_.end())
+    {
+        this->remove(it->second);
+    }
+}
+
+void ChannelSearchIndex::replaceMessage(size_t index,
+                                        const MessagePtr &replacement)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (index >= this->entries_.size())
+    {
+        return;
+    }
+
+    auto id = std::next(this->entries_.begin(), index)->first;
+
+    this->remove(id);
+    this->add(id, replacement);
+}
+
+void ChannelSearchIndex::search(const Query &query,
+                                const ResultCallback &callback) const
+{
+    std::vector<Entry> candidates;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        std::vector<int64_t> ids;
+        bool filtered = false;
+
+        if (!query.fromUsers.isEmpty())
+        {
+            std::set<int64_t> fromIds;
+            for (const auto &user : query.fromUsers)
+            {
+                auto it = this->users_.find(user);
+                if (it != this->users_.end())
+                {
+                    fromIds.insert(it->second.begin(), it->second.end());
+                }
+            }
+
+            ids.assign(fromIds.begin(), fromIds.end());
+            filtered = true;
+        }
+
+        forEachTrigram(query.text, [&](uint64_t trigram) {
+            if (filtered && ids.empty())
+            {
+                return;
+            }
+
+            auto it = this->trigrams_.find(trigram);
+            if (it == this->trigrams_.end())
+            {
+                ids.clear();
+            }
+            else if (filtered)
+            {
+                intersect(ids, it->second);
+            }
+            else
+            {
+                ids.assign(it->second.begin(), it->second.end());
+            }
+
+            filtered = true;
+        });
+
+        if (filtered)
+        {
+            candidates.reserve(ids.size());
+            for (auto id : ids)
+            {
+                candidates.push_back(this->entries_.at(id));
+            }
+        }
+        else
+        {
+            candidates.reserve(this->entries_.size());
+            for (const auto &entry : this->entries_)
+            {
+                candidates.push_back(entry.second);
+            }
+        }
+    }
+
+    // the trigrams only narrow it down, check the actual text
+    std::vector<WeakMessagePtr> batch;
+
+    for (const auto &candidate : candidates)
+    {
+        if ((query.hasLink && !candidate.hasLink) ||
+            (query.isHighlighted && !candidate.isHighlighted) ||
+            (!query.text.isEmpty() &&
+             candidate.searchText.indexOf(query.text, 0,
+                                          Qt::CaseInsensitive) == -1))
+        {
+            continue;
+        }
+
+        batch.push_back(candidate.message);
+
+        if (batch.size() >= batchSize)
+        {
+            if (!callback(batch))
+            {
+                return;
+            }
+            batch.clear();
+        }
+    }
+
+    if (!batch.empty())
+    {
+        callback(batch);
+    }
+}
+
+// mutex_ must be locked
+void ChannelSearchIndex::add(int64_t id, const MessagePtr &message)
+{
+    this->entries_[id] = {message, message.get(), message->searchText,
+                          message->loginName.toLower(), hasLink(*message),
+                          message->flags.has(MessageFlag::Highlighted)};
+    this->ids_[message.get()] = id;
+
+    forEachTrigram(message->searchText, [&](uint64_t trigram) {
+        this->trigrams_[trigram].insert(id);
+    });
+
+    if (!message->loginName.isEmpty())
+    {
+        this->users_[this->entries_[id].loginName].insert(id);
+    }
+}
+
+// mutex_ must be locked
+void ChannelSearchIndex::remove(int64_t id)
+{
+    auto it = this->entries_.find(id);
+    if (it == this->entries_.end())
+    {
+        return;
+    }
+
+    const auto &entry = it->second;
+
+    forEachTrigram(entry.searchText, [&](uint64_t trigram) {
+        auto postings = this->trigrams_.find(trigram);
+        if (postings != this->trigrams_.end())
+        {
+            postings->second.erase(id);
+            if (postings->second.empty())
+            {
+                this->trigrams_.erase(postings);
+            }
+        }
+    });
+
+    auto user = this->users_.find(entry.loginName);
+    if (user != this->users_.end())
+    {
+        user->second.erase(id);
+        if (user->second.empty())
+        {
+            this->users_.erase(user);
+        }
+    }
+
+    this->ids_.erase(entry.pointer);
+    this->entries_.erase(it);
+}
+
+}  // namespace chatterino
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "util/QStringHash.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+
+struct Message;
+using MessagePtr = std::shared_ptr<const Message>;
+
+// Trigram and username postings over the messages of a channel.
+//
+// The channel keeps it up to date as messages are added, removed and
+// replaced, which only happens on the gui thread. search can be called from
+// any thread. Messages must only be released on the gui thread, so the index
+// holds weak references and search hands those out; lock them on the gui
+// thread.
+class ChannelSearchIndex : boost::noncopyable
+{
+public:
+    struct Query {
+        // matched case insensitive anywhere in the message
+        QString text;
+
+        // "from:user", a message has to be from one of them
+        QStringList fromUsers;
+
+        // "has:link"
+        bool hasLink = false;
+
+        // "is:highlighted"
+        bool isHighlighted = false;
+    };
+
+    using WeakMessagePtr = std::weak_ptr<const Message>;
+
+    // return false to stop the search
+    using ResultCallback = std::function<bool(std::vector<WeakMessagePtr> &)>;
+
+    static Query parseQuery(const QString &text);
+
+    void addMessages(const std::vector<MessagePtr> &messages);
+    void addMessagesAtStart(const std::vector<MessagePtr> &messages);
+    void removeMessage(const MessagePtr &message);
+    void replaceMessage(size_t index, const MessagePtr &replacement);
+
+    // Calls callback with the matching messages in batches, oldest first.
+    void search(const Query &query, const ResultCallback &callback) const;
+
+private:
+    struct Entry {
+        WeakMessagePtr message;
+        // key into ids_, only compared
+        const Message *pointer;
+
+        // copied so the worker doesn't have to touch the message
+        QString searchText;
+        QString loginName;
+        bool hasLink;
+        bool isHighlighted;
+    };
+
+    void add(int64_t id, const MessagePtr &message);
+    void remove(int64_t id);
+
+    mutable std::mutex mutex_;
+
+    // ordered the same way as in the channel
+    std::map<int64_t, Entry> entries_;
+    std::unordered_map<const Message *, int64_t> ids_;
+    int64_t nextId_ = 0;
+    int64_t nextIdAtStart_ = -1;
+
+    std::unordered_map<uint64_t, std::set<int64_t>> trigrams_;
+    std::unordered_map<QString, std::set<int64_t>> users_;
+};
+
+}  // namespace chatterino
@@ -7,14 +7,62 @@
 #include "controllers/commands/CommandController.hpp"
 #include "debug/Benchmark.hpp"
 #include "debug/Log.hpp"
+#include "providers/twitch/TwitchAccount.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "providers/twitch/TwitchServer.hpp"
 #include "singletons/Emotes.hpp"
 
 #include <QtAlgorithms>
+#include <algorithm>
+#include <iterator>
 #include <utility>
 
 namespace chatterino {
+namespace {
+    // the completion never shows more than this many items
+    const size_t maxCompletionItems = 100;
+
+    const PrefixIndex &accountEmoteIndex(
+        const std::shared_ptr<TwitchAccount> &account)
+    {
+        static std::weak_ptr<TwitchAccount> indexedAccount;
+        static uint64_t indexedGeneration = 0;
+        static PrefixIndex index;
+
+        auto emotes = account->accessEmotes();
+
+        if (indexedAccount.lock() != account ||
+            indexedGeneration != emotes->generation)
+        {
+            std::vector<QString> names;
+            names.reserve(emotes->allEmoteNames.size());
+            for (const auto &name : emotes->allEmoteNames)
+            {
+                names.push_back(name.string);
+            }
+
+            index = PrefixIndex(names);
+            indexedAccount = account;
+            indexedGeneration = emotes->generation;
+        }
+
+        return index;
+    }
+
+    const PrefixIndex &emojiIndex()
+    {
+        static PrefixIndex index;
+
+        // the emojis are loaded once at startup
+        const auto &shortCodes = getApp()->emotes->emojis.shortCodes;
+        if (index.size() != shortCodes.size())
+        {
+            index = PrefixIndex(shortCodes);
+        }
+
+        return index;
+    }
+}  // namespace
 
 //
 // TaggedString
@@ -47,6 +95,31 @@ bool CompletionModel::TaggedString::operator<(const TaggedString &that) const
     return k < 0;
 }
 
+//
+// EmoteMapIndex
+//
+const PrefixIndex &CompletionModel::EmoteMapIndex::get(
+    const std::shared_ptr<const EmoteMap> &map)
+{
+    if (map != this->map_)
+    {
+        std::vector<QString> names;
+        if (map)
+        {
+            names.reserve(map->size());
+            for (const auto &emote : *map)
+            {
+                names.push_back(emote.first.string);
+            }
+        }
+
+        this->index_ = PrefixIndex(names);
+        this->map_ = map;
+    }
+
+    return this->index_;
+}
+
 //
 // CompletionModel
 //
@@ -89,17 +162,26 @@ void CompletionModel::refresh(const QString &prefix)
             this->items_.emplace(str + " ", type);
     };
 
+    // The emote sources are sorted, so only the first matches of each of them
+    // can make it into the list.
+    auto addMatches = [&](const PrefixIndex &index, const QString &namePrefix,
+                          TaggedString::Type type, const QString &wrap) {
+        size_t count = 0;
+        index.forEachWithPrefix(namePrefix, [&](const QString &name) {
+            this->items_.emplace(wrap + name + wrap + " ", type);
+            return ++count < maxCompletionItems;
+        });
+    };
+
     if (auto channel = dynamic_cast<TwitchChannel *>(&this->channel_))
     {
         // account emotes
         if (auto account = getApp()->accounts->twitch.getCurrent())
         {
-            for (const auto &emote : account->accessEmotes()->allEmoteNames)
-            {
-                // XXX: No way to discern between a twitch global emote and sub
-                // emote right now
-                addString(emote.string, TaggedString::Type::TwitchGlobalEmote);
-            }
+            // XXX: No way to discern between a twitch global emote and sub
+            // emote right now
+            addMatches(accountEmoteIndex(account), prefix,
+                       TaggedString::Type::TwitchGlobalEmote, "");
         }
 
         // Usernames
@@ -108,58 +190,47 @@ void CompletionModel::refresh(const QString &prefix)
             auto usernames = channel->accessChatters();
 
             QString usernamePrefix = prefix;
+            QString at;
 
             if (usernamePrefix.startsWith("@"))
             {
                 usernamePrefix.remove(0, 1);
-                for (const auto &name :
-                     usernames->subrange(Prefix(usernamePrefix)))
-                {
-                    addString("@" + name, TaggedString::Type::Username);
-                }
-            }
-            else
-            {
-                for (const auto &name :
-                     usernames->subrange(Prefix(usernamePrefix)))
-                {
-                    addString(name, TaggedString::Type::Username);
-                }
+                at = "@";
             }
+
+            size_t count = 0;
+            usernames->forEachWithPrefix(usernamePrefix, [&](auto &&name) {
+                this->items_.emplace(at + name + " ",
+                                     TaggedString::Type::Username);
+                return ++count < maxCompletionItems;
+            });
         }
 
+        // shared by all channels
+        static EmoteMapIndex globalBttvEmotes;
+        static EmoteMapIndex globalFfzEmotes;
+
         // Bttv Global
-        for (auto &emote : *channel->globalBttv().emotes())
-        {
-            addString(emote.first.string, TaggedString::Type::BTTVChannelEmote);
-        }
+        addMatches(globalBttvEmotes.get(channel->globalBttv().emotes()),
+                   prefix, TaggedString::Type::BTTVChannelEmote, "");
 
         // Ffz Global
-        for (auto &emote : *channel->globalFfz().emotes())
-        {
-            addString(emote.first.string, TaggedString::Type::FFZChannelEmote);
-        }
+        addMatches(globalFfzEmotes.get(channel->globalFfz().emotes()), prefix,
+                   TaggedString::Type::FFZChannelEmote, "");
 
         // Bttv Channel
-        for (auto &emote : *channel->bttvEmotes())
-        {
-            addString(emote.first.string, TaggedString::Type::BTTVGlobalEmote);
-        }
+        addMatches(this->bttvChannelEmotes_.get(channel->bttvEmotes()), prefix,
+                   TaggedString::Type::BTTVGlobalEmote, "");
 
         // Ffz Channel
-        for (auto &emote : *channel->ffzEmotes())
-        {
-            addString(emote.first.string, TaggedString::Type::BTTVGlobalEmote);
-        }
+        addMatches(this->ffzChannelEmotes_.get(channel->ffzEmotes()), prefix,
+                   TaggedString::Type::BTTVGlobalEmote, "");
 
         // Emojis
         if (prefix.startsWith(":"))
         {
-            const auto &emojiShortCodes = getApp()->emotes->emojis.shortCodes;
-            for (auto &m : emojiShortCodes)
-            {
-                addString(":" + m + ":", TaggedString::Type::Emoji);
-            }
+            addMatches(emojiIndex(), prefix.mid(1), TaggedString::Type::Emoji,
+                       ":");
         }
 
         // Commands
@@ -173,6 +244,30 @@ void CompletionModel::refresh(const QString &prefix)
             addString(command, TaggedString::Command);
         }
     }
+
+    if (this->items_.size() <= maxCompletionItems)
+    {
+        return;
+    }
+
+    // Emotes sort before everything else, so just cutting off the end would
+    // drop all usernames and commands once there are enough emotes. Both
+    // sides get half of the items, and what one side doesn't use goes to the
+    // other one.
+    auto firstOther = std::find_if(
+        this->items_.begin(), this->items_.end(),
+        [](const TaggedString &item) { return !item.isEmote(); });
+
+    size_t emotes = size_t(std::distance(this->items_.begin(), firstOther));
+    size_t others = this->items_.size() - emotes;
+
+    size_t keepOthers = std::min(
+        others, maxCompletionItems - std::min(emotes, maxCompletionItems / 2));
+    size_t keepEmotes = std::min(emotes, maxCompletionItems - keepOthers);
+
+    this->items_.erase(std::next(firstOther, keepOthers), this->items_.end());
+    this->items_.erase(std::next(this->items_.begin(), keepEmotes),
+                       firstOther);
 }
 
 }  // namespace chatterino
@@ -1,14 +1,18 @@
 #pragma once
 
+#include "common/PrefixIndex.hpp"
+
 #include <QAbstractListModel>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <set>
 
 namespace chatterino {
 
 class Channel;
+class EmoteMap;
 
 class CompletionModel : public QAbstractListModel
 {
@@ -49,9 +53,23 @@ public:
 
     void refresh(const QString &prefix);
 
+    // sorted names of an emote map, rebuilt when the map is replaced
+    class EmoteMapIndex
+    {
+    public:
+        const PrefixIndex &get(const std::shared_ptr<const EmoteMap> &map);
+
+    private:
+        std::shared_ptr<const EmoteMap> map_;
+        PrefixIndex index_;
+    };
+
 private:
     TaggedString createUser(const QString &str);
 
+    EmoteMapIndex bttvChannelEmotes_;
+    EmoteMapIndex ffzChannelEmotes_;
+
     std::set<TaggedString> items_;
     mutable std::mutex itemsMutex_;
     Channel &channel_;
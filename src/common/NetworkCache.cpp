@@ -0,0 +1,388 @@
+#include "common/NetworkCache.hpp"
+
+#include "debug/Log.hpp"
+#include "singletons/Paths.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <vector>
+
+namespace chatterino {
+namespace {
+
+    const quint32 indexMagic = 0x43484e43;  // "CHNC"
+    const quint32 indexVersion = 1;
+
+    const qint64 maxCacheSize = 512 * 1024 * 1024;
+    // evicting down to a bit below the limit keeps us from evicting on every
+    // store once the cache is full
+    const qint64 evictTarget = maxCacheSize / 10 * 9;
+
+    const qint64 indexSaveInterval = 30;
+
+    QString indexPath(const QString &directory)
+    {
+        return directory + "/index.dat";
+    }
+
+    qint64 now()
+    {
+        return QDateTime::currentSecsSinceEpoch();
+    }
+
+    bool isHexName(const QString &name, int length)
+    {
+        return name.size() == length &&
+               std::all_of(name.begin(), name.end(), [](QChar c) {
+                   return c.isDigit() || (c >= 'a' && c <= 'f');
+               });
+    }
+
+}  // namespace
+
+NetworkCache &NetworkCache::getInstance()
+{
+    static NetworkCache instance;
+    return instance;
+}
+
+NetworkCache::NetworkCache()
+{
+    // a single thread, tasks run in the order they were queued
+    this->thread_.setMaxThreadCount(1);
+}
+
+void NetworkCache::load(const QString &key, LoadCallback callback)
+{
+    this->run([this, key, callback = std::move(callback)] {
+        auto it = this->index_.find(key);
+        if (it == this->index_.end())
+        {
+            callback(boost::none);
+            return;
+        }
+
+        QFile file(this->blobPath(it->second.blob));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            // the file got deleted behind our back
+            this->removeEntry(it);
+            callback(boost::none);
+            return;
+        }
+
+        Entry entry;
+        entry.data = file.readAll();
+        entry.etag = it->second.etag;
+        entry.lastModified = it->second.lastModified;
+        entry.fresh = now() < it->second.expires;
+
+        it->second.lastUsed = now();
+        this->dirty_ = true;
+
+        callback(std::move(entry));
+    });
+}
+
+void NetworkCache::store(const QString &key, const QByteArray &data,
+                         const QByteArray &etag,
+                         const QByteArray &lastModified, qint64 maxAgeSeconds)
+{
+    this->run([=] {
+        QString blob =
+            QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+
+        auto it = this->index_.find(key);
+        if (it != this->index_.end() && it->second.blob != blob)
+        {
+            this->removeEntry(it);
+            it = this->index_.end();
+        }
+
+        if (it == this->index_.end())
+        {
+            auto &refs = this->blobRefs_[blob];
+
+            if (refs == 0)
+            {
+                QFile file(this->blobPath(blob));
+                if (!file.open(QIODevice::WriteOnly) ||
+                    file.write(data) != data.size())
+                {
+                    this->blobRefs_.erase(blob);
+                    return;
+                }
+
+                this->totalSize_ += data.size();
+            }
+
+            refs++;
+
+            it = this->index_.emplace(key, IndexEntry()).first;
+            it->second.blob = blob;
+            it->second.size = data.size();
+        }
+
+        it->second.lastUsed = now();
+        it->second.expires = now() + maxAgeSeconds;
+        it->second.etag = etag;
+        it->second.lastModified = lastModified;
+        this->dirty_ = true;
+
+        this->evict();
+        this->saveIndexIfDue();
+    });
+}
+
+void NetworkCache::refresh(const QString &key, qint64 maxAgeSeconds)
+{
+    this->run([=] {
+        auto it = this->index_.find(key);
+        if (it == this->index_.end())
+        {
+            return;
+        }
+
+        it->second.lastUsed = now();
+        it->second.expires = now() + maxAgeSeconds;
+        this->dirty_ = true;
+
+        this->saveIndexIfDue();
+    });
+}
+
+void NetworkCache::remove(const QString &key)
+{
+    this->run([=] {
+        auto it = this->index_.find(key);
+        if (it != this->index_.end())
+        {
+            this->removeEntry(it);
+        }
+    });
+}
+
+void NetworkCache::flush()
+{
+    this->run([this] {
+        if (this->dirty_)
+        {
+            this->saveIndex();
+        }
+    });
+
+    this->thread_.waitForDone();
+}
+
+void NetworkCache::run(std::function<void()> task)
+{
+    this->thread_.start(new LambdaRunnable([this, task = std::move(task)] {
+        this->ensureLoaded();
+        task();
+    }));
+}
+
+void NetworkCache::ensureLoaded()
+{
+    // the cache directory can be changed in the settings and might be shared
+    // with other files, everything of ours goes into a directory we own
+    auto directory = getPaths()->cacheDirectory() + "/blobs";
+
+    if (directory == this->directory_)
+    {
+        return;
+    }
+
+    if (!this->directory_.isEmpty() && this->dirty_)
+    {
+        this->saveIndex();
+    }
+
+    this->directory_ = directory;
+    QDir().mkpath(this->directory_);
+    this->loadIndex();
+    this->reconcileBlobs();
+}
+
+void NetworkCache::loadIndex()
+{
+    this->index_.clear();
+    this->blobRefs_.clear();
+    this->totalSize_ = 0;
+    this->dirty_ = false;
+    this->lastSave_ = now();
+
+    QFile file(indexPath(this->directory_));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream stream(&file);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+
+    if (magic != indexMagic || version != indexVersion)
+    {
+        log("Ignoring network cache index with unknown version {}", version);
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString key;
+        IndexEntry entry;
+
+        stream >> key >> entry.blob >> entry.size >> entry.lastUsed >>
+            entry.expires >> entry.etag >> entry.lastModified;
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            break;
+        }
+
+        if (this->blobRefs_[entry.blob]++ == 0)
+        {
+            this->totalSize_ += entry.size;
+        }
+
+        this->index_.emplace(std::move(key), std::move(entry));
+    }
+}
+
+void NetworkCache::saveIndex()
+{
+    QSaveFile file(indexPath(this->directory_));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+
+    QDataStream stream(&file);
+
+    stream << indexMagic << indexVersion << quint32(this->index_.size());
+
+    for (const auto &pair : this->index_)
+    {
+        const auto &entry = pair.second;
+
+        stream << pair.first << entry.blob << entry.size << entry.lastUsed
+               << entry.expires << entry.etag << entry.lastModified;
+    }
+
+    if (file.commit())
+    {
+        this->dirty_ = false;
+        this->lastSave_ = now();
+    }
+}
+
+void NetworkCache::saveIndexIfDue()
+{
+    if (this->dirty_ && now() - this->lastSave_ >= indexSaveInterval)
+    {
+        this->saveIndex();
+    }
+}
+
+void NetworkCache::reconcileBlobs()
+{
+    // bodies stored after the index was last saved aren't in it. Nothing
+    // would ever evict them, so they get deleted. Only done in our own
+    // directory.
+    QDir dir(this->directory_);
+    std::unordered_set<QString> found;
+
+    for (const auto &name : dir.entryList(QDir::Files))
+    {
+        // sha1 in hex
+        if (!isHexName(name, 40))
+        {
+            continue;
+        }
+
+        if (this->blobRefs_.count(name) == 0)
+        {
+            dir.remove(name);
+        }
+        else
+        {
+            found.insert(name);
+        }
+    }
+
+    // and entries whose body is gone would count towards the size limit
+    for (auto it = this->index_.begin(); it != this->index_.end();)
+    {
+        auto next = std::next(it);
+
+        if (found.count(it->second.blob) == 0)
+        {
+            this->removeEntry(it);
+        }
+
+        it = next;
+    }
+}
+
+void NetworkCache::removeEntry(Index::iterator it)
+{
+    auto refs = this->blobRefs_.find(it->second.blob);
+
+    if (refs != this->blobRefs_.end() && --refs->second <= 0)
+    {
+        QFile::remove(this->blobPath(it->second.blob));
+        this->totalSize_ -= it->second.size;
+        this->blobRefs_.erase(refs);
+    }
+
+    this->index_.erase(it);
+    this->dirty_ = true;
+}
+
+void NetworkCache::evict()
+{
+    if (this->totalSize_ <= maxCacheSize)
+    {
+        return;
+    }
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(this->index_.size());
+
+    for (const auto &pair : this->index_)
+    {
+        byAge.emplace_back(pair.second.lastUsed, pair.first);
+    }
+
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto &item : byAge)
+    {
+        if (this->totalSize_ <= evictTarget)
+        {
+            break;
+        }
+
+        this->removeEntry(this->index_.find(item.second));
+    }
+}
+
+QString NetworkCache::blobPath(const QString &blob) const
+{
+    return this->directory_ + "/" + blob;
+}
+
+}  // namespace chatterino
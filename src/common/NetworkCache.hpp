@@ -0,0 +1,90 @@
+#pragma once
+
+#include "util/QStringHash.hpp"
+
+#include <QByteArray>
+#include <QString>
+#include <QThreadPool>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+namespace chatterino {
+
+// Disk cache for the bodies of network responses.
+//
+// Bodies are stored content addressed in the "blobs" directory inside the
+// cache directory, one file per distinct body named after its hash. The cache
+// only deletes files in there. A single index file maps request hashes to
+// bodies and remembers the ETag/Last-Modified headers, so stale entries can be
+// revalidated instead of downloaded again. Once the cache grows past its size
+// limit the least recently used entries are evicted.
+//
+// All file access happens on one worker thread. The index is only touched
+// from that thread, so it needs no locking.
+class NetworkCache : boost::noncopyable
+{
+public:
+    struct Entry {
+        QByteArray data;
+        QByteArray etag;
+        QByteArray lastModified;
+        // false if the entry should be revalidated before it's used
+        bool fresh = false;
+    };
+
+    using LoadCallback = std::function<void(boost::optional<Entry>)>;
+
+    static NetworkCache &getInstance();
+
+    // the callback is called on the cache thread
+    void load(const QString &key, LoadCallback callback);
+    void store(const QString &key, const QByteArray &data,
+               const QByteArray &etag, const QByteArray &lastModified,
+               qint64 maxAgeSeconds);
+    // marks an entry as fresh again after the server told us it's unchanged
+    void refresh(const QString &key, qint64 maxAgeSeconds);
+    void remove(const QString &key);
+
+    // writes the index and waits for all pending work, call before exiting
+    void flush();
+
+private:
+    struct IndexEntry {
+        QString blob;
+        qint64 size = 0;
+        qint64 lastUsed = 0;
+        qint64 expires = 0;
+        QByteArray etag;
+        QByteArray lastModified;
+    };
+    using Index = std::unordered_map<QString, IndexEntry>;
+
+    NetworkCache();
+
+    void run(std::function<void()> task);
+
+    // everything below is only called on the cache thread
+    void ensureLoaded();
+    void loadIndex();
+    void saveIndex();
+    void saveIndexIfDue();
+    void reconcileBlobs();
+    void removeEntry(Index::iterator it);
+    void evict();
+    QString blobPath(const QString &blob) const;
+
+    QThreadPool thread_;
+
+    QString directory_;
+    Index index_;
+    // number of index entries using a body
+    std::unordered_map<QString, int> blobRefs_;
+    qint64 totalSize_ = 0;
+    qint64 lastSave_ = 0;
+    bool dirty_ = false;
+};
+
+}  // namespace chatterino
@@ -20,4 +20,11 @@ enum class NetworkRequestType {
     Delete,
 };
 
+// requests to the same host are sent in this order
+enum class NetworkRequestPriority {
+    High,
+    Normal,
+    Low,
+};
+
 }  // namespace chatterino
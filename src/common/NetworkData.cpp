@@ -1,12 +1,47 @@
 #include "common/NetworkData.hpp"
 
-#include "singletons/Paths.hpp"
+#include "common/NetworkCache.hpp"
 #include "util/DebugCount.hpp"
 
 #include <QCryptographicHash>
-#include <QFile>
+#include <QNetworkReply>
+#include <QRegularExpression>
+
+#include <algorithm>
 
 namespace chatterino {
+namespace {
+
+    // used when the server doesn't say how long the response stays valid
+    const qint64 defaultMaxAge = 24 * 60 * 60;
+
+    // returns -1 if the response must not be stored at all
+    qint64 getMaxAge(QNetworkReply *reply)
+    {
+        auto cacheControl = QString::fromLatin1(
+            reply->rawHeader("Cache-Control").toLower());
+
+        if (cacheControl.contains("no-store"))
+        {
+            return -1;
+        }
+        if (cacheControl.contains("no-cache"))
+        {
+            return 0;
+        }
+
+        static QRegularExpression maxAgeRegex("max-age=(\\d+)");
+        auto match = maxAgeRegex.match(cacheControl);
+
+        if (match.hasMatch())
+        {
+            return match.captured(1).toLongLong();
+        }
+
+        return defaultMaxAge;
+    }
+
+}  // namespace
 
 NetworkData::NetworkData()
 {
@@ -40,19 +75,30 @@ QString NetworkData::getHash()
     return this->hash_;
 }
 
-void NetworkData::writeToCache(const QByteArray &bytes)
+void NetworkData::writeToCache(const QByteArray &bytes, QNetworkReply *reply)
 {
     if (this->useQuickLoadCache_)
     {
-        QFile cachedFile(getPaths()->cacheDirectory() + "/" + this->getHash());
+        auto maxAge = getMaxAge(reply);
 
-        if (cachedFile.open(QIODevice::WriteOnly))
+        if (maxAge < 0)
         {
-            cachedFile.write(bytes);
-
-            cachedFile.close();
+            NetworkCache::getInstance().remove(this->getHash());
+            return;
         }
+
+        NetworkCache::getInstance().store(
+            this->getHash(), bytes, reply->rawHeader("ETag"),
+            reply->rawHeader("Last-Modified"), maxAge);
     }
 }
 
+void NetworkData::refreshCache(QNetworkReply *reply)
+{
+    auto maxAge = getMaxAge(reply);
+
+    NetworkCache::getInstance().refresh(this->getHash(),
+                                        std::max<qint64>(maxAge, 0));
+}
+
 }  // namespace chatterino
@@ -3,6 +3,7 @@
 #include "common/NetworkCommon.hpp"
 
 #include <QNetworkRequest>
+#include <boost/optional.hpp>
 
 #include <functional>
 
@@ -26,12 +27,17 @@ struct NetworkData {
     NetworkSuccessCallback onSuccess_;
 
     NetworkRequestType requestType_ = NetworkRequestType::Get;
+    NetworkRequestPriority priority_ = NetworkRequestPriority::Normal;
 
     QByteArray payload_;
 
+    // body of a stale cache entry that is being revalidated
+    boost::optional<QByteArray> cachedData_;
+
     QString getHash();
 
-    void writeToCache(const QByteArray &bytes);
+    void writeToCache(const QByteArray &bytes, QNetworkReply *reply);
+    void refreshCache(QNetworkReply *reply);
 
 private:
     QString hash_;
@@ -1,14 +1,15 @@
 #include "common/NetworkRequest.hpp"
 
+#include "common/NetworkCache.hpp"
 #include "common/NetworkData.hpp"
-#include "common/NetworkManager.hpp"
+#include "common/NetworkScheduler.hpp"
 #include "common/Outcome.hpp"
 #include "debug/Log.hpp"
 #include "providers/twitch/TwitchCommon.hpp"
-#include "singletons/Paths.hpp"
 #include "util/DebugCount.hpp"
+#include "util/PostToThread.hpp"
 
-#include <QFile>
+#include <QPointer>
 #include <QtConcurrent>
 
 #include <cassert>
@@ -104,6 +105,11 @@ void NetworkRequest::setPayload(const QByteArray &payload)
     this->data->payload_ = payload;
 }
 
+void NetworkRequest::setPriority(NetworkRequestPriority priority)
+{
+    this->data->priority_ = priority;
+}
+
 void NetworkRequest::setUseQuickLoadCache(bool value)
 {
     this->data->useQuickLoadCache_ = value;
@@ -120,14 +126,11 @@ void NetworkRequest::execute()
             // Get requests try to load from cache, then perform the request
             if (this->data->useQuickLoadCache_)
             {
-                if (this->tryLoadCachedFile())
-                {
-                    // Successfully loaded from cache
-                    return;
-                }
+                this->loadFromCache();
+                return;
             }
 
-            this->doRequest();
+            doRequest(this->data, this->timer);
         }
         break;
 
@@ -135,7 +138,7 @@ void NetworkRequest::execute()
         {
             // Put requests cannot be cached, therefore the request is called
             // immediately
-            this->doRequest();
+            doRequest(this->data, this->timer);
         }
         break;
 
@@ -143,7 +146,7 @@ void NetworkRequest::execute()
         {
             // Delete requests cannot be cached, therefore the request is called
             // immediately
-            this->doRequest();
+            doRequest(this->data, this->timer);
         }
         break;
 
@@ -160,149 +163,71 @@ QString NetworkRequest::urlString() const
     return this->data->request_.url().toString();
 }
 
-Outcome NetworkRequest::tryLoadCachedFile()
-{
-    QFile cachedFile(getPaths()->cacheDirectory() + "/" +
-                     this->data->getHash());
-
-    if (!cachedFile.exists())
-    {
-        // File didn't exist
-        return Failure;
-    }
-
-    if (!cachedFile.open(QIODevice::ReadOnly))
-    {
-        // File could not be opened
-        return Failure;
-    }
-
-    QByteArray bytes = cachedFile.readAll();
-    NetworkResult result(bytes);
-
-    auto outcome = this->data->onSuccess_(result);
-
-    cachedFile.close();
-
-    // XXX: If success is false, we should invalidate the cache file
-    // somehow/somewhere
-
-    return outcome;
-}
-
-void NetworkRequest::doRequest()
+void NetworkRequest::loadFromCache()
 {
-    DebugCount::increase("http request started");
+    auto data = this->data;
+    auto timer = this->timer;
 
-    NetworkRequester requester;
-    NetworkWorker *worker = new NetworkWorker;
+    // QPointer so we notice if the caller is destroyed in the meantime
+    bool hasCaller = data->caller_ != nullptr;
+    QPointer<QObject> caller(const_cast<QObject *>(data->caller_));
 
-    worker->moveToThread(&NetworkManager::workerThread);
+    // the hash includes the header names, so compute it before the
+    // revalidation headers are added
+    auto key = data->getHash();
 
-    this->timer->start();
-
-    auto onUrlRequested = [data = this->data, timer = this->timer,
-                           worker]() mutable {
-        auto reply = [&]() -> QNetworkReply * {
-            switch (data->requestType_)
-            {
-                case NetworkRequestType::Get:
-                    return NetworkManager::accessManager.get(data->request_);
-
-                case NetworkRequestType::Put:
-                    return NetworkManager::accessManager.put(data->request_,
-                                                             data->payload_);
-
-                case NetworkRequestType::Delete:
-                    return NetworkManager::accessManager.deleteResource(
-                        data->request_);
-
-                default:
-                    return nullptr;
-            }
-        }();
-
-        if (reply == nullptr)
+    NetworkCache::getInstance().load(key, [=](auto entry) {
+        if (!entry)
         {
-            log("Unhandled request type");
+            doRequest(data, timer);
             return;
         }
 
-        if (timer->isStarted())
+        if (!entry->fresh)
         {
-            timer->onTimeout(worker, [reply, data]() {
-                log("Aborted!");
-                reply->abort();
-                if (data->onError_)
-                {
-                    data->onError_(-2);
-                }
-            });
-        }
+            // ask the server whether our copy is still up to date
+            data->cachedData_ = entry->data;
 
-        if (data->onReplyCreated_)
-        {
-            data->onReplyCreated_(reply);
-        }
-
-        auto handleReply = [data, timer, reply]() mutable {
-            // TODO(pajlada): A reply was received, kill the timeout timer
-            if (reply->error() != QNetworkReply::NetworkError::NoError)
+            if (!entry->etag.isEmpty())
             {
-                if (data->onError_)
-                {
-                    data->onError_(reply->error());
-                }
-                return;
+                data->request_.setRawHeader("If-None-Match", entry->etag);
+            }
+            if (!entry->lastModified.isEmpty())
+            {
+                data->request_.setRawHeader("If-Modified-Since",
+                                            entry->lastModified);
             }
 
-            QByteArray bytes = reply->readAll();
-            data->writeToCache(bytes);
+            doRequest(data, timer);
+            return;
+        }
 
-            NetworkResult result(bytes);
+        auto onLoaded = [data, timer, bytes = entry->data]() mutable {
+            DebugCount::increase("http request cached");
 
-            DebugCount::increase("http request success");
-            // log("starting {}", data->request_.url().toString());
-            if (data->onSuccess_)
+            if (!data->onSuccess_(NetworkResult(std::move(bytes))))
             {
-                if (data->executeConcurrently)
-                    QtConcurrent::run(
-                        [onSuccess = std::move(data->onSuccess_),
-                         result = std::move(result)] { onSuccess(result); });
-                else
-                    data->onSuccess_(result);
+                // the cached data is unusable, get a fresh copy
+                NetworkCache::getInstance().remove(data->getHash());
+                doRequest(data, timer);
             }
-            // log("finished {}", data->request_.url().toString());
-
-            reply->deleteLater();
         };
 
-        if (data->caller_ != nullptr)
+        if (data->executeConcurrently || !hasCaller)
         {
-            QObject::connect(worker, &NetworkWorker::doneUrl, data->caller_,
-                             handleReply);
-            QObject::connect(reply, &QNetworkReply::finished, worker,
-                             [worker]() mutable {
-                                 emit worker->doneUrl();
-
-                                 delete worker;
-                             });
+            QtConcurrent::run(onLoaded);
         }
-        else
+        else if (caller)
         {
-            QObject::connect(reply, &QNetworkReply::finished, worker,
-                             [handleReply, worker]() mutable {
-                                 handleReply();
-
-                                 delete worker;
-                             });
+            postToThread(std::move(onLoaded), caller.data());
         }
-    };
-
-    QObject::connect(&requester, &NetworkRequester::requestUrl, worker,
-                     onUrlRequested);
+    });
+}
 
-    emit requester.requestUrl();
+void NetworkRequest::doRequest(std::shared_ptr<NetworkData> data,
+                               std::shared_ptr<NetworkTimer> timer)
+{
+    NetworkScheduler::schedule(std::move(data), std::move(timer));
 }
 
 // Helper creator functions
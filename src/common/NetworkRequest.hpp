@@ -1,10 +1,8 @@
 #pragma once
 
 #include "common/NetworkCommon.hpp"
-#include "common/NetworkRequester.hpp"
 #include "common/NetworkResult.hpp"
 #include "common/NetworkTimer.hpp"
-#include "common/NetworkWorker.hpp"
 
 namespace chatterino {
 
@@ -45,6 +43,7 @@ public:
     void onSuccess(NetworkSuccessCallback cb);
 
     void setPayload(const QByteArray &payload);
+    void setPriority(NetworkRequestPriority priority);
     void setUseQuickLoadCache(bool value);
     void setCaller(const QObject *caller);
     void setRawHeader(const char *headerName, const char *value);
@@ -60,10 +59,13 @@ public:
     QString urlString() const;
 
 private:
-    // "invalid" data "invalid" is specified by the onSuccess callback
-    Outcome tryLoadCachedFile();
+    // Looks the request up in the NetworkCache on the cache thread. Falls back
+    // to a (conditional) request if there is no usable entry. "usable" is
+    // specified by the onSuccess callback
+    void loadFromCache();
 
-    void doRequest();
+    static void doRequest(std::shared_ptr<NetworkData> data,
+                          std::shared_ptr<NetworkTimer> timer);
 
 public:
     // Helper creator functions
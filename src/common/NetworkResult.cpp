@@ -8,8 +8,8 @@
 
 namespace chatterino {
 
-NetworkResult::NetworkResult(const QByteArray &data)
-    : data_(data)
+NetworkResult::NetworkResult(QByteArray &&data)
+    : data_(std::move(data))
 {
 }
 
@@ -33,14 +33,19 @@ rapidjson::Document NetworkResult::parseRapidJson() const
 
     if (result.Code() != rapidjson::kParseErrorNone)
     {
-        log("JSON parse error: {} ({})",
-            rapidjson::GetParseError_En(result.Code()), result.Offset());
+        logParseError(result);
         return ret;
     }
 
     return ret;
 }
 
+void NetworkResult::logParseError(const rapidjson::ParseResult &result)
+{
+    log("JSON parse error: {} ({})", rapidjson::GetParseError_En(result.Code()),
+        result.Offset());
+}
+
 const QByteArray &NetworkResult::getData() const
 {
     return this->data_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <QJsonObject>
 
 namespace chatterino {
@@ -8,13 +9,44 @@ namespace chatterino {
 class NetworkResult
 {
 public:
-    NetworkResult(const QByteArray &data);
+    explicit NetworkResult(QByteArray &&data);
+
+    // the data can be big, so it can only be moved around
+    NetworkResult(NetworkResult &&other) = default;
+    NetworkResult &operator=(NetworkResult &&other) = default;
+    NetworkResult(const NetworkResult &other) = delete;
+    NetworkResult &operator=(const NetworkResult &other) = delete;
 
     QJsonObject parseJson() const;
     rapidjson::Document parseRapidJson() const;
+
+    // Streams the json into the handler without building a document.
+    // Numbers are passed to RawNumber as text. Returns false if the json is
+    // invalid or the handler stopped the parser.
+    template <typename Handler>
+    bool parseJsonSax(Handler &handler) const
+    {
+        // QByteArray is always null terminated
+        rapidjson::StringStream stream(this->data_.constData());
+        rapidjson::Reader reader;
+
+        auto result = reader.Parse<rapidjson::kParseNumbersAsStringsFlag>(
+            stream, handler);
+
+        if (result.IsError())
+        {
+            logParseError(result);
+            return false;
+        }
+
+        return true;
+    }
+
     const QByteArray &getData() const;
 
 private:
+    static void logParseError(const rapidjson::ParseResult &result);
+
     QByteArray data_;
 };
 
@@ -0,0 +1,385 @@
+#include "common/NetworkScheduler.hpp"
+
+#include "common/NetworkData.hpp"
+#include "common/NetworkManager.hpp"
+#include "common/NetworkResult.hpp"
+#include "common/NetworkTimer.hpp"
+#include "debug/Log.hpp"
+#include "util/DebugCount.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+    // same as the number of connections QNetworkAccessManager opens per host,
+    // so the requests wait in our queues where the priorities apply
+    const int maxRequestsPerHost = 6;
+
+    // requests with the same key can share a reply
+    QString coalescingKey(const NetworkData &data)
+    {
+        if (data.requestType_ != NetworkRequestType::Get)
+        {
+            return QString();
+        }
+
+        QByteArray key = data.request_.url().toEncoded();
+
+        for (const auto &header : data.request_.rawHeaderList())
+        {
+            key += '\n' + header + ": " + data.request_.rawHeader(header);
+        }
+
+        return QString::fromUtf8(key);
+    }
+}  // namespace
+
+bool NetworkScheduler::Request::isAlive() const
+{
+    return !this->hasCaller || !this->caller.isNull();
+}
+
+NetworkScheduler &NetworkScheduler::getInstance()
+{
+    // created on the network thread, so context_ lives there
+    static NetworkScheduler instance;
+    return instance;
+}
+
+void NetworkScheduler::schedule(std::shared_ptr<NetworkData> data,
+                                std::shared_ptr<NetworkTimer> timer)
+{
+    // QPointer so we notice if the caller is destroyed in the meantime
+    Request request;
+    request.hasCaller = data->caller_ != nullptr;
+    request.caller = const_cast<QObject *>(data->caller_);
+    request.data = std::move(data);
+
+    // the timeout timer needs a thread with an event loop
+    postToThread(
+        [request = std::move(request), timer = std::move(timer)]() mutable {
+            getInstance().add(std::move(request), std::move(timer));
+        },
+        &NetworkManager::accessManager);
+}
+
+void NetworkScheduler::add(Request request, std::shared_ptr<NetworkTimer> timer)
+{
+    auto caller = request.caller.data();
+    if (request.hasCaller && caller == nullptr)
+    {
+        return;
+    }
+
+    auto data = request.data;
+    auto key = coalescingKey(*data);
+
+    GroupPtr group;
+    if (!key.isEmpty())
+    {
+        auto it = this->groups_.find(key);
+        if (it != this->groups_.end())
+        {
+            group = it->second;
+        }
+    }
+
+    bool isNew = group == nullptr;
+
+    if (isNew)
+    {
+        group = std::make_shared<Group>();
+        group->key = key;
+        group->host = data->request_.url().host();
+
+        if (!key.isEmpty())
+        {
+            this->groups_[key] = group;
+        }
+    }
+    else
+    {
+        DebugCount::increase("http request coalesced");
+    }
+
+    std::weak_ptr<Group> weakGroup = group;
+
+    if (request.hasCaller)
+    {
+        request.callerDestroyed = QObject::connect(
+            caller, &QObject::destroyed, &this->context_, [this, weakGroup] {
+                if (auto group = weakGroup.lock())
+                {
+                    this->removeRequests(group, nullptr);
+                }
+            });
+    }
+
+    timer->start();
+    if (timer->isStarted())
+    {
+        timer->onTimeout(&this->context_, [this, weakGroup, data] {
+            auto group = weakGroup.lock();
+            if (!group ||
+                std::none_of(group->requests.begin(), group->requests.end(),
+                             [&](auto &&other) {
+                                 return other.data == data;
+                             }))
+            {
+                return;
+            }
+
+            log("Aborted!");
+            this->removeRequests(group, data);
+
+            if (data->onError_)
+            {
+                data->onError_(-2);
+            }
+        });
+    }
+
+    if (group->reply != nullptr && data->onReplyCreated_)
+    {
+        data->onReplyCreated_(group->reply);
+    }
+
+    group->requests.push_back(std::move(request));
+
+    if (isNew)
+    {
+        auto &host = this->hosts_[group->host];
+
+        if (host.inFlight < maxRequestsPerHost)
+        {
+            this->start(group);
+        }
+        else
+        {
+            host.queues[size_t(data->priority_)].push_back(group);
+        }
+    }
+}
+
+bool NetworkScheduler::start(const GroupPtr &group)
+{
+    // callers might have been destroyed while it was queued
+    this->removeRequests(group, nullptr);
+
+    if (group->requests.empty())
+    {
+        return false;
+    }
+
+    auto &data = group->requests.front().data;
+
+    auto reply = [&]() -> QNetworkReply * {
+        switch (data->requestType_)
+        {
+            case NetworkRequestType::Get:
+                return NetworkManager::accessManager.get(data->request_);
+
+            case NetworkRequestType::Put:
+                return NetworkManager::accessManager.put(data->request_,
+                                                         data->payload_);
+
+            case NetworkRequestType::Delete:
+                return NetworkManager::accessManager.deleteResource(
+                    data->request_);
+
+            default:
+                return nullptr;
+        }
+    }();
+
+    if (reply == nullptr)
+    {
+        log("Unhandled request type");
+        this->groups_.erase(group->key);
+        return false;
+    }
+
+    DebugCount::increase("http request started");
+
+    group->reply = reply;
+    this->hosts_[group->host].inFlight++;
+
+    for (auto &request : group->requests)
+    {
+        if (request.data->onReplyCreated_)
+        {
+            request.data->onReplyCreated_(reply);
+        }
+    }
+
+    QObject::connect(reply, &QNetworkReply::finished, &this->context_,
+                     [this, group] { this->finish(group); });
+
+    return true;
+}
+
+void NetworkScheduler::startNext(const QString &hostName)
+{
+    auto &host = this->hosts_[hostName];
+
+    // the queues are ordered by priority
+    for (auto &queue : host.queues)
+    {
+        while (!queue.empty() && host.inFlight < maxRequestsPerHost)
+        {
+            auto group = std::move(queue.front());
+            queue.pop_front();
+
+            this->start(group);
+        }
+    }
+
+    if (host.inFlight == 0 &&
+        std::all_of(host.queues.begin(), host.queues.end(),
+                    [](auto &&queue) { return queue.empty(); }))
+    {
+        this->hosts_.erase(hostName);
+    }
+}
+
+void NetworkScheduler::finish(const GroupPtr &group)
+{
+    auto reply = group->reply;
+
+    auto it = this->groups_.find(group->key);
+    if (it != this->groups_.end() && it->second == group)
+    {
+        this->groups_.erase(it);
+    }
+
+    std::vector<Request> requests;
+    requests.swap(group->requests);
+
+    if (!requests.empty())
+    {
+        auto error = reply->error();
+        QByteArray bytes;
+
+        if (error == QNetworkReply::NoError)
+        {
+            // the requests are identical, so any of them can update the cache
+            auto &data = requests.front().data;
+
+            if (data->cachedData_ &&
+                reply->attribute(QNetworkRequest::HttpStatusCodeAttribute)
+                        .toInt() == 304)
+            {
+                bytes = data->cachedData_.get();
+                data->refreshCache(reply);
+            }
+            else
+            {
+                bytes = reply->readAll();
+                data->writeToCache(bytes, reply);
+            }
+
+            DebugCount::increase("http request success");
+        }
+
+        for (auto &request : requests)
+        {
+            QObject::disconnect(request.callerDestroyed);
+            this->deliver(request, error, bytes);
+        }
+    }
+
+    reply->deleteLater();
+
+    this->hosts_[group->host].inFlight--;
+    this->startNext(group->host);
+}
+
+// removes the request with the data, or all requests whose caller is gone if
+// data is nullptr
+void NetworkScheduler::removeRequests(const GroupPtr &group,
+                                      const std::shared_ptr<NetworkData> &data)
+{
+    auto &requests = group->requests;
+
+    auto end = std::remove_if(
+        requests.begin(), requests.end(), [&](const Request &request) {
+            return data ? request.data == data : !request.isAlive();
+        });
+
+    for (auto it = end; it != requests.end(); it++)
+    {
+        QObject::disconnect(it->callerDestroyed);
+    }
+    requests.erase(end, requests.end());
+
+    if (!requests.empty())
+    {
+        return;
+    }
+
+    // nobody is waiting for it anymore
+    auto it = this->groups_.find(group->key);
+    if (it != this->groups_.end() && it->second == group)
+    {
+        this->groups_.erase(it);
+    }
+
+    if (group->reply != nullptr && group->reply->isRunning())
+    {
+        DebugCount::increase("http request cancelled");
+        group->reply->abort();
+    }
+}
+
+void NetworkScheduler::deliver(const Request &request,
+                               QNetworkReply::NetworkError error,
+                               const QByteArray &bytes)
+{
+    auto data = request.data;
+
+    // QByteArray is implicitly shared, so requests that shared a reply don't
+    // copy the data
+    auto handleReply = [data, error, bytes]() mutable {
+        if (error != QNetworkReply::NoError)
+        {
+            if (data->onError_)
+            {
+                data->onError_(error);
+            }
+            return;
+        }
+
+        if (data->onSuccess_)
+        {
+            if (data->executeConcurrently)
+                QtConcurrent::run(
+                    [onSuccess = std::move(data->onSuccess_),
+                     bytes = std::move(bytes)]() mutable {
+                        onSuccess(NetworkResult(std::move(bytes)));
+                    });
+            else
+                data->onSuccess_(NetworkResult(std::move(bytes)));
+        }
+    };
+
+    if (!request.hasCaller)
+    {
+        handleReply();
+        return;
+    }
+
+    // the connection is dropped if the caller is destroyed before the event
+    // is delivered
+    if (auto caller = request.caller.data())
+    {
+        NetworkWorker worker;
+        QObject::connect(&worker, &NetworkWorker::doneUrl, caller,
+                         handleReply);
+        emit worker.doneUrl();
+    }
+}
+
+}  // namespace chatterino
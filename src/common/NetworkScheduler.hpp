@@ -0,0 +1,81 @@
+#pragma once
+
+#include "common/NetworkCommon.hpp"
+#include "common/NetworkWorker.hpp"
+#include "util/QStringHash.hpp"
+
+#include <QNetworkReply>
+#include <QPointer>
+#include <QString>
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+
+struct NetworkData;
+class NetworkTimer;
+
+// Decides when requests are sent, everything but schedule runs on the network
+// thread.
+//
+// - identical GET requests share one reply while it's queued or in flight
+// - every host has at most maxRequestsPerHost requests in flight, the rest
+//   wait in a queue per priority
+// - requests whose caller was destroyed are dropped, a reply nobody is
+//   waiting for anymore is aborted
+class NetworkScheduler : boost::noncopyable
+{
+public:
+    // can be called from any thread
+    static void schedule(std::shared_ptr<NetworkData> data,
+                         std::shared_ptr<NetworkTimer> timer);
+
+private:
+    struct Request {
+        std::shared_ptr<NetworkData> data;
+        bool hasCaller = false;
+        QPointer<QObject> caller;
+        QMetaObject::Connection callerDestroyed;
+
+        bool isAlive() const;
+    };
+
+    // requests that share a reply
+    struct Group {
+        QString key;
+        QString host;
+        std::vector<Request> requests;
+        QNetworkReply *reply = nullptr;
+    };
+    using GroupPtr = std::shared_ptr<Group>;
+
+    struct Host {
+        int inFlight = 0;
+        std::array<std::deque<GroupPtr>, 3> queues;
+    };
+
+    NetworkScheduler() = default;
+    static NetworkScheduler &getInstance();
+
+    void add(Request request, std::shared_ptr<NetworkTimer> timer);
+    bool start(const GroupPtr &group);
+    void startNext(const QString &host);
+    void finish(const GroupPtr &group);
+    void removeRequests(const GroupPtr &group,
+                        const std::shared_ptr<NetworkData> &data);
+    void deliver(const Request &request, QNetworkReply::NetworkError error,
+                 const QByteArray &bytes);
+
+    // context for the connections, lives on the network thread
+    NetworkWorker context_;
+
+    std::unordered_map<QString, GroupPtr> groups_;
+    std::unordered_map<QString, Host> hosts_;
+};
+
+}  // namespace chatterino
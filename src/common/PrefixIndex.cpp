@@ -0,0 +1,24 @@
+#include "common/PrefixIndex.hpp"
+
+#include <algorithm>
+
+namespace chatterino {
+
+PrefixIndex::PrefixIndex(const std::vector<QString> &names)
+{
+    this->names_.reserve(names.size());
+
+    for (const auto &name : names)
+    {
+        this->names_.emplace_back(name.toLower(), name);
+    }
+
+    std::sort(this->names_.begin(), this->names_.end());
+}
+
+size_t PrefixIndex::size() const
+{
+    return this->names_.size();
+}
+
+}  // namespace chatterino
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QString>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace chatterino {
+
+// Names sorted case insensitively, so all names starting with a prefix are
+// next to each other and can be found with a binary search.
+class PrefixIndex
+{
+public:
+    PrefixIndex() = default;
+    explicit PrefixIndex(const std::vector<QString> &names);
+
+    // Calls f with the names starting with prefix (case insensitive) in order
+    // until f returns false.
+    template <typename F>
+    void forEachWithPrefix(const QString &prefix, F &&f) const
+    {
+        auto lowerPrefix = prefix.toLower();
+
+        auto it = std::lower_bound(
+            this->names_.begin(), this->names_.end(), lowerPrefix,
+            [](const Entry &entry, const QString &value) {
+                return entry.first < value;
+            });
+
+        for (; it != this->names_.end() && it->first.startsWith(lowerPrefix);
+             it++)
+        {
+            if (!f(it->second))
+            {
+                return;
+            }
+        }
+    }
+
+    size_t size() const;
+
+private:
+    // lowercase name, name
+    using Entry = std::pair<QString, QString>;
+
+    std::vector<Entry> names_;
+};
+
+}  // namespace chatterino
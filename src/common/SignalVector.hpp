@@ -4,6 +4,7 @@
 #include <QTimer>
 #include <boost/noncopyable.hpp>
 #include <pajlada/signals/signal.hpp>
+#include <memory>
 #include <vector>
 
 #include "debug/AssertInGuiThread.hpp"
@@ -41,6 +42,13 @@ public:
         return this->vector_;
     }
 
+    // Returns a copy of the items that can be read from any thread. The copy
+    // is replaced whenever an item is inserted or removed.
+    std::shared_ptr<const std::vector<TVectorItem>> readOnly() const
+    {
+        return std::atomic_load(&this->readOnly_);
+    }
+
     void invokeDelayedItemsChanged()
     {
         assertInGuiThread();
@@ -54,7 +62,16 @@ public:
     virtual bool isSorted() const = 0;
 
 protected:
+    void updateReadOnly()
+    {
+        std::atomic_store(
+            &this->readOnly_,
+            std::make_shared<const std::vector<TVectorItem>>(this->vector_));
+    }
+
     std::vector<TVectorItem> vector_;
+    std::shared_ptr<const std::vector<TVectorItem>> readOnly_ =
+        std::make_shared<const std::vector<TVectorItem>>();
     QTimer itemsChangedTimer_;
 };
 
@@ -73,6 +90,7 @@ public:
 
         TVectorItem item = this->vector_[index];
         this->vector_.erase(this->vector_.begin() + index);
+        this->updateReadOnly();
         SignalVectorItemArgs<TVectorItem> args{item, index, caller};
         this->itemRemoved.invoke(args);
 
@@ -103,6 +121,7 @@ public:
         }
 
         this->vector_.insert(this->vector_.begin() + index, item);
+        this->updateReadOnly();
 
         SignalVectorItemArgs<TVectorItem> args{item, index, caller};
         this->itemInserted.invoke(args);
@@ -129,6 +148,7 @@ public:
                                    item, Compare{});
         int index = it - this->vector_.begin();
         this->vector_.insert(it, item);
+        this->updateReadOnly();
 
         SignalVectorItemArgs<TVectorItem> args{item, index, caller};
         this->itemInserted.invoke(args);
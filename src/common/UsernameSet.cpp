@@ -1,120 +1,290 @@
 #include "UsernameSet.hpp"
 
-#include <tuple>
+#include "util/DebugCount.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 namespace chatterino {
+namespace {
+    // names are prefixed with their length as a single byte
+    const int maxNameLength = 255;
+
+    // recently inserted names are merged into the sorted ones after this many
+    const size_t maxRecentNames = 512;
+
+    char fold(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+    }
 
-//
-// UsernameSet
-//
+    // compares ascii case insensitively, everything else byte by byte
+    int compareFolded(const char *a, int aLength, const char *b, int bLength)
+    {
+        auto length = std::min(aLength, bLength);
+
+        for (int i = 0; i < length; i++)
+        {
+            auto x = uint8_t(fold(a[i]));
+            auto y = uint8_t(fold(b[i]));
+
+            if (x != y)
+            {
+                return x < y ? -1 : 1;
+            }
+        }
 
-UsernameSet::ConstIterator UsernameSet::begin() const
+        return aLength - bLength;
+    }
+}  // namespace
+
+UsernameSet::UsernameSet(const std::vector<QString> &names)
 {
-    return this->items.begin();
+    Offsets offsets;
+    offsets.reserve(names.size());
+
+    for (const auto &name : names)
+    {
+        auto utf8 = name.toUtf8();
+        if (utf8.isEmpty() || utf8.size() > maxNameLength)
+        {
+            continue;
+        }
+
+        offsets.push_back(uint32_t(this->names_.size()));
+        this->names_.append(char(utf8.size()));
+        this->names_.append(utf8);
+    }
+
+    this->sortAndMerge(offsets);
+    this->updateDebugCount();
 }
 
-UsernameSet::ConstIterator UsernameSet::end() const
+UsernameSet::UsernameSet(UsernameSet &&other)
 {
-    return this->items.end();
+    *this = std::move(other);
 }
 
-UsernameSet::Range UsernameSet::subrange(const Prefix &prefix) const
+UsernameSet &UsernameSet::operator=(UsernameSet &&other)
 {
-    auto it = this->firstKeyForPrefix.find(prefix);
-    if (it != this->firstKeyForPrefix.end())
+    if (this != &other)
     {
-        auto start = this->items.find(it->second);
-        auto end = start;
+        this->names_ = std::move(other.names_);
+        this->sorted_ = std::move(other.sorted_);
+        this->recent_ = std::move(other.recent_);
+        this->garbage_ = other.garbage_;
 
-        while (end != this->items.end() && prefix.isStartOf(*end))
-        {
-            end++;
-        }
-        return {start, end};
+        other.names_.clear();
+        other.sorted_.clear();
+        other.recent_.clear();
+        other.garbage_ = 0;
+
+        this->updateDebugCount();
+        other.updateDebugCount();
     }
 
-    return {this->items.end(), this->items.end()};
+    return *this;
 }
 
-std::set<QString>::size_type UsernameSet::size() const
+UsernameSet::~UsernameSet()
 {
-    return this->items.size();
+    DebugCount::decrease("username set memory (KB)", this->reportedMemory_);
 }
 
-std::pair<UsernameSet::Iterator, bool> UsernameSet::insert(const QString &value)
+size_t UsernameSet::size() const
 {
-    this->insertPrefix(value);
-
-    return this->items.insert(value);
+    return this->sorted_.size() + this->recent_.size();
 }
 
-std::pair<UsernameSet::Iterator, bool> UsernameSet::insert(QString &&value)
+void UsernameSet::insert(const QString &name)
 {
-    this->insertPrefix(value);
+    auto utf8 = name.toUtf8();
+    if (utf8.isEmpty() || utf8.size() > maxNameLength)
+    {
+        return;
+    }
+
+    for (auto offsets : {&this->sorted_, &this->recent_})
+    {
+        auto it = this->find(*offsets, utf8);
+        if (it != offsets->end())
+        {
+            // only the casing of ascii letters can differ, so it fits
+            std::memcpy(this->names_.data() + *it + 1, utf8.constData(),
+                        size_t(utf8.size()));
+            return;
+        }
+    }
+
+    auto offset = uint32_t(this->names_.size());
+    this->names_.append(char(utf8.size()));
+    this->names_.append(utf8);
 
-    return this->items.insert(std::move(value));
+    auto position =
+        std::upper_bound(this->recent_.begin(), this->recent_.end(), offset,
+                         [this](uint32_t a, uint32_t b) {
+                             return this->less(a, b);
+                         });
+    this->recent_.insert(position, offset);
+
+    if (this->recent_.size() >= maxRecentNames)
+    {
+        this->mergeRecent();
+    }
 }
 
-void UsernameSet::insertPrefix(const QString &value)
+void UsernameSet::remove(const QString &name)
 {
-    auto &string = this->firstKeyForPrefix[Prefix(value)];
+    auto utf8 = name.toUtf8();
 
-    if (string.isNull() || value < string)
-        string = value;
+    for (auto offsets : {&this->sorted_, &this->recent_})
+    {
+        auto it = this->find(*offsets, utf8);
+        if (it != offsets->end())
+        {
+            this->garbage_ += 1 + uint8_t(this->names_[int(*it)]);
+            offsets->erase(it);
+            break;
+        }
+    }
+
+    if (this->garbage_ > 4096 &&
+        this->garbage_ > size_t(this->names_.size()) / 2)
+    {
+        this->compact();
+    }
 }
 
-//
-// Range
-//
+size_t UsernameSet::getMemoryUsage() const
+{
+    return size_t(this->names_.capacity()) +
+           (this->sorted_.capacity() + this->recent_.capacity()) *
+               sizeof(uint32_t);
+}
 
-UsernameSet::Range::Range(ConstIterator start, ConstIterator end)
-    : start_(start)
-    , end_(end)
+UsernameSet::Range UsernameSet::prefixRange(const Offsets &offsets,
+                                            const QByteArray &prefix) const
 {
+    auto data = this->names_.constData();
+
+    auto compare = [&](uint32_t offset, int length) {
+        auto nameLength = std::min(int(uint8_t(data[offset])), length);
+        return compareFolded(data + offset + 1, nameLength, prefix.constData(),
+                             length);
+    };
+
+    auto begin = std::lower_bound(
+        offsets.begin(), offsets.end(), prefix,
+        [&](uint32_t offset, const QByteArray &) {
+            return compare(offset, prefix.size()) < 0;
+        });
+
+    auto end = std::upper_bound(
+        begin, offsets.end(), prefix, [&](const QByteArray &, uint32_t offset) {
+            return compare(offset, prefix.size()) > 0;
+        });
+
+    return {begin, end};
 }
 
-UsernameSet::ConstIterator UsernameSet::Range::begin()
+UsernameSet::Offsets::iterator UsernameSet::find(Offsets &offsets,
+                                                 const QByteArray &name)
 {
-    return this->start_;
+    auto data = this->names_.constData();
+
+    auto it = std::lower_bound(
+        offsets.begin(), offsets.end(), name,
+        [&](uint32_t offset, const QByteArray &value) {
+            return compareFolded(data + offset + 1, uint8_t(data[offset]),
+                                 value.constData(), value.size()) < 0;
+        });
+
+    if (it != offsets.end() &&
+        compareFolded(data + *it + 1, uint8_t(data[*it]), name.constData(),
+                      name.size()) == 0)
+    {
+        return it;
+    }
+
+    return offsets.end();
 }
 
-UsernameSet::ConstIterator UsernameSet::Range::end()
+bool UsernameSet::less(uint32_t a, uint32_t b) const
 {
-    return this->end_;
+    auto data = this->names_.constData();
+
+    return compareFolded(data + a + 1, uint8_t(data[a]), data + b + 1,
+                         uint8_t(data[b])) < 0;
 }
 
-//
-// Prefix
-//
+QString UsernameSet::nameAt(uint32_t offset) const
+{
+    auto data = this->names_.constData();
+
+    return QString::fromUtf8(data + offset + 1, uint8_t(data[offset]));
+}
 
-Prefix::Prefix(const QString &string)
-    : first(string.size() >= 1 ? string[0].toLower() : '\0')
-    , second(string.size() >= 2 ? string[1].toLower() : '\0')
+// sorts the new offsets, drops duplicates and merges them into sorted_
+void UsernameSet::sortAndMerge(Offsets &offsets)
 {
+    auto less = [this](uint32_t a, uint32_t b) { return this->less(a, b); };
+
+    std::stable_sort(offsets.begin(), offsets.end(), less);
+
+    auto end = std::unique(offsets.begin(), offsets.end(),
+                           [&](uint32_t a, uint32_t b) {
+                               return !less(a, b) && !less(b, a);
+                           });
+    offsets.erase(end, offsets.end());
+
+    Offsets merged;
+    merged.reserve(this->sorted_.size() + offsets.size());
+    std::merge(this->sorted_.begin(), this->sorted_.end(), offsets.begin(),
+               offsets.end(), std::back_inserter(merged), less);
+
+    merged.shrink_to_fit();
+    this->sorted_ = std::move(merged);
 }
 
-bool Prefix::operator==(const Prefix &other) const
+void UsernameSet::mergeRecent()
 {
-    return std::tie(this->first, this->second) ==
-           std::tie(other.first, other.second);
+    Offsets recent;
+    recent.swap(this->recent_);
+
+    this->sortAndMerge(recent);
+    this->updateDebugCount();
 }
 
-bool Prefix::isStartOf(const QString &string) const
+// copies the names that are still in the set into a new buffer
+void UsernameSet::compact()
 {
-    if (string.size() == 0)
-    {
-        return this->first == QChar('\0') && this->second == QChar('\0');
-    }
-    else if (string.size() == 1)
-    {
-        return this->first == string[0].toLower() &&
-               this->second == QChar('\0');
-    }
-    else
+    this->mergeRecent();
+
+    QByteArray names;
+    names.reserve(this->names_.size() - int(this->garbage_));
+
+    for (auto &offset : this->sorted_)
     {
-        return this->first == string[0].toLower() &&
-               this->second == string[1].toLower();
+        auto length = 1 + uint8_t(this->names_[int(offset)]);
+        auto newOffset = uint32_t(names.size());
+
+        names.append(this->names_.constData() + offset, length);
+        offset = newOffset;
     }
+
+    this->names_ = std::move(names);
+    this->garbage_ = 0;
+    this->updateDebugCount();
+}
+
+void UsernameSet::updateDebugCount()
+{
+    auto memory = int64_t(this->getMemoryUsage() / 1024);
+
+    DebugCount::increase("username set memory (KB)",
+                         memory - this->reportedMemory_);
+    this->reportedMemory_ = memory;
 }
 
 }  // namespace chatterino
@@ -1,73 +1,86 @@
 #pragma once
 
+#include <QByteArray>
 #include <QString>
-#include <functional>
-#include <set>
-#include <unordered_map>
 
-namespace chatterino {
-class Prefix
-{
-public:
-    Prefix(const QString &string);
-    bool operator==(const Prefix &other) const;
-    bool isStartOf(const QString &string) const;
-
-private:
-    QChar first;
-    QChar second;
-
-    friend struct std::hash<Prefix>;
-};
-}  // namespace chatterino
-
-namespace std {
-template <>
-struct hash<chatterino::Prefix> {
-    size_t operator()(const chatterino::Prefix &prefix) const
-    {
-        return (size_t(prefix.first.unicode()) << 16) |
-               size_t(prefix.second.unicode());
-    }
-};
-}  // namespace std
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace chatterino {
+
+// Chatter names, compared case insensitively.
+//
+// Every name is stored once, as utf8 prefixed with its length, in a single
+// buffer. The index are two sorted arrays of offsets into that buffer: a big
+// one and a small one for the names that were inserted since they were last
+// merged. Finding all names with a prefix is a binary search in both.
 class UsernameSet
 {
 public:
     static constexpr int PrefixLength = 2;
 
-    using Iterator = std::set<QString>::iterator;
-    using ConstIterator = std::set<QString>::const_iterator;
+    UsernameSet() = default;
+    explicit UsernameSet(const std::vector<QString> &names);
+    UsernameSet(UsernameSet &&other);
+    UsernameSet &operator=(UsernameSet &&other);
+    ~UsernameSet();
 
-    class Range
+    // Calls f with the names starting with prefix (case insensitive) in order
+    // until f returns false.
+    template <typename F>
+    void forEachWithPrefix(const QString &prefix, F &&f) const
     {
-    public:
-        Range(ConstIterator start, ConstIterator end);
+        auto key = prefix.toUtf8();
+        auto a = this->prefixRange(this->sorted_, key);
+        auto b = this->prefixRange(this->recent_, key);
+
+        while (a.first != a.second || b.first != b.second)
+        {
+            bool fromSorted =
+                b.first == b.second ||
+                (a.first != a.second && this->less(*a.first, *b.first));
+
+            auto offset = fromSorted ? *a.first++ : *b.first++;
+
+            if (!f(this->nameAt(offset)))
+            {
+                return;
+            }
+        }
+    }
 
-        ConstIterator begin();
-        ConstIterator end();
+    size_t size() const;
 
-    private:
-        ConstIterator start_;
-        ConstIterator end_;
-    };
+    // the casing of the name replaces the one of an existing name
+    void insert(const QString &name);
+    void remove(const QString &name);
 
-    ConstIterator begin() const;
-    ConstIterator end() const;
-    Range subrange(const Prefix &prefix) const;
+    // bytes used by the names and the index
+    size_t getMemoryUsage() const;
 
-    std::set<QString>::size_type size() const;
+private:
+    using Offsets = std::vector<uint32_t>;
+    using Range = std::pair<Offsets::const_iterator, Offsets::const_iterator>;
 
-    std::pair<Iterator, bool> insert(const QString &value);
-    std::pair<Iterator, bool> insert(QString &&value);
+    Range prefixRange(const Offsets &offsets, const QByteArray &prefix) const;
+    Offsets::iterator find(Offsets &offsets, const QByteArray &name);
+    bool less(uint32_t a, uint32_t b) const;
+    QString nameAt(uint32_t offset) const;
 
-private:
-    void insertPrefix(const QString &string);
+    void sortAndMerge(Offsets &offsets);
+    void mergeRecent();
+    void compact();
+    void updateDebugCount();
+
+    QByteArray names_;
+    Offsets sorted_;
+    Offsets recent_;
+
+    // bytes of removed names that are still in names_
+    size_t garbage_ = 0;
 
-    std::set<QString> items;
-    std::unordered_map<Prefix, QString> firstKeyForPrefix;
+    int64_t reportedMemory_ = 0;
 };
 
 }  // namespace chatterino
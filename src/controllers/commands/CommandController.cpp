@@ -9,6 +9,7 @@
 #include "messages/Message.hpp"
 #include "messages/MessageBuilder.hpp"
 #include "messages/MessageElement.hpp"
+#include "providers/twitch/PubsubClient.hpp"
 #include "providers/twitch/TwitchApi.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "providers/twitch/TwitchServer.hpp"
@@ -232,6 +233,24 @@ QString CommandController::execCommand(const QString &textNoEmoji, ChannelPtr ch
 
                 return "";
             }
+            else if (commandName == "/debug-pubsub")
+            {
+                auto stats = getApp()->twitch.pubsub->getClientStats();
+
+                channel->addMessage(makeSystemMessage(
+                    QString("%1 PubSub connections").arg(stats.size())));
+
+                for (size_t i = 0; i < stats.size(); i++)
+                {
+                    channel->addMessage(makeSystemMessage(
+                        QString("Connection %1: %2 topics, %3 messages/min")
+                            .arg(i + 1)
+                            .arg(stats[i].topics)
+                            .arg(stats[i].messagesPerMinute, 0, 'f', 1)));
+                }
+
+                return "";
+            }
             else if (commandName == "/uptime")
             {
                 const auto &streamStatus = twitchChannel->accessStreamStatus();
@@ -1,14 +1,21 @@
 #include "HighlightController.hpp"
 
 #include "Application.hpp"
+#include "controllers/accounts/AccountController.hpp"
 #include "controllers/highlights/HighlightBlacklistModel.hpp"
+#include "controllers/highlights/HighlightMatcher.hpp"
 #include "controllers/highlights/HighlightModel.hpp"
 #include "controllers/highlights/UserHighlightModel.hpp"
+#include "singletons/Settings.hpp"
 #include "widgets/dialogs/NotificationPopup.hpp"
 
 namespace chatterino {
 
 HighlightController::HighlightController()
+    : phraseMatcher_(std::make_shared<HighlightMatcher>(
+          std::vector<HighlightPhrase>()))
+    , userMatcher_(
+          std::make_shared<HighlightMatcher>(std::vector<HighlightPhrase>()))
 {
 }
 
@@ -24,8 +31,24 @@ void HighlightController::initialize(Settings &settings, Paths &paths)
 
     this->phrases.delayedItemsChanged.connect([this] {  //
         this->highlightsSetting_.setValue(this->phrases.getVector());
+        this->rebuildPhraseMatcher();
     });
 
+    this->highlightedUsers.delayedItemsChanged.connect(
+        [this] { this->rebuildUserMatcher(); });
+
+    // the self highlight is part of the phrase matcher
+    this->selfHighlightListener_.addSetting(settings.enableSelfHighlight);
+    this->selfHighlightListener_.addSetting(settings.enableSelfHighlightSound);
+    this->selfHighlightListener_.addSetting(
+        settings.enableSelfHighlightTaskbar);
+    this->selfHighlightListener_.cb = [this](auto) {
+        this->rebuildPhraseMatcher();
+    };
+
+    getApp()->accounts->twitch.currentUserChanged.connect(
+        [this] { this->rebuildPhraseMatcher(); });
+
     for (const HighlightBlacklistUser &blacklistedUser :
          this->blacklistSetting_.getValue())
     {
@@ -35,6 +58,49 @@ void HighlightController::initialize(Settings &settings, Paths &paths)
     this->blacklistedUsers.delayedItemsChanged.connect([this] {
         this->blacklistSetting_.setValue(this->blacklistedUsers.getVector());
     });
+
+    this->rebuildPhraseMatcher();
+    this->rebuildUserMatcher();
+}
+
+std::shared_ptr<const HighlightMatcher> HighlightController::getPhraseMatcher()
+    const
+{
+    return std::atomic_load(&this->phraseMatcher_);
+}
+
+std::shared_ptr<const HighlightMatcher> HighlightController::getUserMatcher()
+    const
+{
+    return std::atomic_load(&this->userMatcher_);
+}
+
+void HighlightController::rebuildPhraseMatcher()
+{
+    std::vector<HighlightPhrase> phrases = this->phrases.getVector();
+
+    auto currentUser = getApp()->accounts->twitch.getCurrent();
+    const auto &currentUsername = currentUser->getUserName();
+
+    if (getSettings()->enableSelfHighlight && !currentUsername.isEmpty())
+    {
+        phrases.emplace_back(currentUsername,
+                             getSettings()->enableSelfHighlightTaskbar,
+                             getSettings()->enableSelfHighlightSound, false);
+    }
+
+    std::atomic_store(&this->phraseMatcher_,
+                      std::shared_ptr<const HighlightMatcher>(
+                          std::make_shared<HighlightMatcher>(
+                              std::move(phrases))));
+}
+
+void HighlightController::rebuildUserMatcher()
+{
+    std::atomic_store(&this->userMatcher_,
+                      std::shared_ptr<const HighlightMatcher>(
+                          std::make_shared<HighlightMatcher>(
+                              this->highlightedUsers.getVector())));
 }
 
 HighlightModel *HighlightController::createModel(QObject *parent)
@@ -55,16 +121,7 @@ UserHighlightModel *HighlightController::createUserModel(QObject *parent)
 
 bool HighlightController::isHighlightedUser(const QString &username)
 {
-    const auto &userItems = this->highlightedUsers.getVector();
-    for (const auto &highlightedUser : userItems)
-    {
-        if (highlightedUser.isMatch(username))
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return !this->getUserMatcher()->match(username).empty();
 }
 
 HighlightBlacklistModel *HighlightController::createBlacklistModel(
@@ -78,9 +135,8 @@ HighlightBlacklistModel *HighlightController::createBlacklistModel(
 
 bool HighlightController::blacklistContains(const QString &username)
 {
-    std::vector<HighlightBlacklistUser> blacklistItems =
-        this->blacklistedUsers.getVector();
-    for (const auto &blacklistedUser : blacklistItems)
+    auto blacklistItems = this->blacklistedUsers.readOnly();
+    for (const auto &blacklistedUser : *blacklistItems)
     {
         if (blacklistedUser.isMatch(username))
         {
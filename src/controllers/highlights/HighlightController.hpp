@@ -6,6 +6,10 @@
 #include "controllers/highlights/HighlightBlacklistUser.hpp"
 #include "controllers/highlights/HighlightPhrase.hpp"
 
+#include <pajlada/settings/settinglistener.hpp>
+
+#include <memory>
+
 namespace chatterino {
 
 struct Message;
@@ -17,6 +21,7 @@ class Paths;
 class UserHighlightModel;
 class HighlightModel;
 class HighlightBlacklistModel;
+class HighlightMatcher;
 
 class HighlightController final : public Singleton
 {
@@ -34,13 +39,26 @@ public:
     UserHighlightModel *createUserModel(QObject *parent);
 
     bool isHighlightedUser(const QString &username);
+
+    // Compiled versions of the phrases (plus the self highlight) and the
+    // highlighted users. They are rebuilt when the items change and can be
+    // used from any thread.
+    std::shared_ptr<const HighlightMatcher> getPhraseMatcher() const;
+    std::shared_ptr<const HighlightMatcher> getUserMatcher() const;
     bool blacklistContains(const QString &username);
 
     void addHighlight(const MessagePtr &msg);
 
 private:
+    void rebuildPhraseMatcher();
+    void rebuildUserMatcher();
+
     bool initialized_ = false;
 
+    std::shared_ptr<const HighlightMatcher> phraseMatcher_;
+    std::shared_ptr<const HighlightMatcher> userMatcher_;
+    pajlada::Settings::SettingListener selfHighlightListener_;
+
     ChatterinoSetting<std::vector<HighlightPhrase>> highlightsSetting_ = {
         "/highlighting/highlights"};
     ChatterinoSetting<std::vector<HighlightBlacklistUser>> blacklistSetting_ = {
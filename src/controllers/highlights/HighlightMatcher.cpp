@@ -0,0 +1,138 @@
+#include "controllers/highlights/HighlightMatcher.hpp"
+
+namespace chatterino {
+namespace {
+
+    // same as \w with unicode properties enabled
+    bool isWordCharacter(const QString &subject, int index)
+    {
+        if (index < 0 || index >= subject.size())
+        {
+            return false;
+        }
+
+        auto c = subject[index];
+        return c.isLetterOrNumber() || c == '_';
+    }
+
+    // same as \b
+    bool isWordBoundary(const QString &subject, int index)
+    {
+        return isWordCharacter(subject, index - 1) !=
+               isWordCharacter(subject, index);
+    }
+
+}  // namespace
+
+HighlightMatcher::HighlightMatcher(std::vector<HighlightPhrase> phrases)
+    : phrases_(std::move(phrases))
+    , words_(Qt::CaseInsensitive)
+{
+    QString merged = "^";
+
+    for (int i = 0; i < int(this->phrases_.size()); i++)
+    {
+        const auto &phrase = this->phrases_[i];
+
+        if (!phrase.isValid())
+        {
+            continue;
+        }
+
+        if (!phrase.isRegex())
+        {
+            this->words_.add(phrase.getPattern(), i);
+        }
+        else if (phrase.getRegex().captureCount() == 0)
+        {
+            // every phrase gets an optional lookahead so one match call
+            // reports all of them, not just the leftmost one
+            merged += "(?:(?=[\\s\\S]*?(" + phrase.getPattern() + "))|)";
+            this->mergedIndices_.push_back(i);
+        }
+        else
+        {
+            this->separateIndices_.push_back(i);
+        }
+    }
+
+    this->words_.build();
+
+    if (!this->mergedIndices_.empty())
+    {
+        this->mergedRegex_ = QRegularExpression(
+            merged, QRegularExpression::CaseInsensitiveOption |
+                        QRegularExpression::UseUnicodePropertiesOption);
+
+        if (this->mergedRegex_.isValid() &&
+            this->mergedRegex_.captureCount() ==
+                int(this->mergedIndices_.size()))
+        {
+            this->mergedRegex_.optimize();
+        }
+        else
+        {
+            // something in one of the patterns doesn't survive being merged
+            this->separateIndices_.insert(this->separateIndices_.end(),
+                                          this->mergedIndices_.begin(),
+                                          this->mergedIndices_.end());
+            this->mergedIndices_.clear();
+            this->mergedRegex_ = QRegularExpression();
+        }
+    }
+}
+
+std::vector<const HighlightPhrase *> HighlightMatcher::match(
+    const QString &subject) const
+{
+    std::vector<bool> matched(this->phrases_.size(), false);
+
+    this->words_.findAll(subject, [&](int index, int start, int length) {
+        if (!matched[index] && isWordBoundary(subject, start) &&
+            isWordBoundary(subject, start + length))
+        {
+            matched[index] = true;
+        }
+        return true;
+    });
+
+    if (!this->mergedIndices_.empty())
+    {
+        auto match = this->mergedRegex_.match(subject);
+
+        for (int i = 0; i < int(this->mergedIndices_.size()); i++)
+        {
+            if (match.capturedStart(i + 1) != -1)
+            {
+                matched[this->mergedIndices_[i]] = true;
+            }
+        }
+    }
+
+    for (int index : this->separateIndices_)
+    {
+        if (!matched[index] && this->phrases_[index].isMatch(subject))
+        {
+            matched[index] = true;
+        }
+    }
+
+    std::vector<const HighlightPhrase *> result;
+
+    for (size_t i = 0; i < matched.size(); i++)
+    {
+        if (matched[i])
+        {
+            result.push_back(&this->phrases_[i]);
+        }
+    }
+
+    return result;
+}
+
+bool HighlightMatcher::isEmpty() const
+{
+    return this->phrases_.empty();
+}
+
+}  // namespace chatterino
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "controllers/highlights/HighlightPhrase.hpp"
+#include "util/PhraseAutomaton.hpp"
+
+#include <QRegularExpression>
+#include <QString>
+
+#include <vector>
+
+namespace chatterino {
+
+// A set of highlight phrases compiled for matching many of them at once.
+//
+// Plain phrases are looked up with one Aho-Corasick automaton, regex phrases
+// are merged into a single expression. Regexes with capture groups can not be
+// merged without changing their group numbers, those are matched one by one.
+//
+// The matcher is immutable once constructed and can be used from any thread.
+class HighlightMatcher
+{
+public:
+    explicit HighlightMatcher(std::vector<HighlightPhrase> phrases);
+
+    // returns the matching phrases in the order they were passed in
+    std::vector<const HighlightPhrase *> match(const QString &subject) const;
+
+    bool isEmpty() const;
+
+private:
+    std::vector<HighlightPhrase> phrases_;
+
+    PhraseAutomaton words_;
+
+    QRegularExpression mergedRegex_;
+    // phrase index for every capture group of mergedRegex_
+    std::vector<int> mergedIndices_;
+
+    std::vector<int> separateIndices_;
+};
+
+}  // namespace chatterino
@@ -60,6 +60,11 @@ public:
         return this->isValid() && this->regex_.match(subject).hasMatch();
     }
 
+    const QRegularExpression &getRegex() const
+    {
+        return this->regex_;
+    }
+
 private:
     QString pattern_;
     bool alert_;
@@ -1,12 +1,19 @@
 #include "controllers/ignores/IgnoreController.hpp"
 
 #include "Application.hpp"
+#include "controllers/accounts/AccountController.hpp"
 #include "controllers/ignores/IgnoreModel.hpp"
 
 #include <cassert>
 
 namespace chatterino {
 
+IgnoreController::BlockIndex::BlockIndex()
+    : caseSensitive(Qt::CaseSensitive)
+    , caseInsensitive(Qt::CaseInsensitive)
+{
+}
+
 void IgnoreController::initialize(Settings &, Paths &)
 {
     assert(!this->initialized_);
@@ -19,7 +26,10 @@ void IgnoreController::initialize(Settings &, Paths &)
 
     this->phrases.delayedItemsChanged.connect([this] {  //
         this->ignoresSetting_.setValue(this->phrases.getVector());
+        this->rebuildBlockIndex();
     });
+
+    this->rebuildBlockIndex();
 }
 
 IgnoreModel *IgnoreController::createModel(QObject *parent)
@@ -30,4 +40,130 @@ IgnoreModel *IgnoreController::createModel(QObject *parent)
     return model;
 }
 
+boost::optional<IgnorePhrase> IgnoreController::findBlockingPhrase(
+    const QString &message) const
+{
+    auto index = std::atomic_load(&this->blockIndex_);
+
+    int found = -1;
+
+    auto onMatch = [&](int i, int, int) {
+        found = i;
+        return false;
+    };
+
+    index->caseSensitive.findAll(message, onMatch);
+    if (found == -1)
+    {
+        index->caseInsensitive.findAll(message, onMatch);
+    }
+    if (found != -1)
+    {
+        return index->phrases[found];
+    }
+
+    if (!index->mergedIndices.empty())
+    {
+        auto match = index->mergedRegex.match(message);
+
+        if (match.hasMatch())
+        {
+            for (int i = 0; i < int(index->mergedIndices.size()); i++)
+            {
+                if (match.capturedStart(i + 1) != -1)
+                {
+                    return index->phrases[index->mergedIndices[i]];
+                }
+            }
+        }
+    }
+
+    for (int i : index->separateIndices)
+    {
+        if (index->phrases[i].isMatch(message))
+        {
+            return index->phrases[i];
+        }
+    }
+
+    return boost::none;
+}
+
+bool IgnoreController::isBlockedUser(const QString &userId) const
+{
+    auto ids = getApp()->accounts->twitch.getCurrent()->getIgnoredUserIds();
+
+    return ids->find(userId) != ids->end();
+}
+
+void IgnoreController::rebuildBlockIndex()
+{
+    auto index = std::make_shared<BlockIndex>();
+    QString merged;
+
+    for (const auto &phrase : this->phrases.getVector())
+    {
+        if (!phrase.isBlock() || phrase.getPattern().isEmpty())
+        {
+            continue;
+        }
+
+        int i = int(index->phrases.size());
+        index->phrases.push_back(phrase);
+
+        if (!phrase.isRegex())
+        {
+            (phrase.isCaseSensitive() ? index->caseSensitive
+                                      : index->caseInsensitive)
+                .add(phrase.getPattern(), i);
+        }
+        else if (!phrase.isRegexValid())
+        {
+            continue;
+        }
+        else if (phrase.getRegex().captureCount() == 0)
+        {
+            if (!merged.isEmpty())
+            {
+                merged += '|';
+            }
+            // options set inside a group only apply to that group
+            merged += (phrase.isCaseSensitive() ? "(" : "((?i)") +
+                      phrase.getPattern() + ")";
+            index->mergedIndices.push_back(i);
+        }
+        else
+        {
+            index->separateIndices.push_back(i);
+        }
+    }
+
+    index->caseSensitive.build();
+    index->caseInsensitive.build();
+
+    if (!index->mergedIndices.empty())
+    {
+        index->mergedRegex = QRegularExpression(
+            merged, QRegularExpression::UseUnicodePropertiesOption);
+
+        if (index->mergedRegex.isValid() &&
+            index->mergedRegex.captureCount() ==
+                int(index->mergedIndices.size()))
+        {
+            index->mergedRegex.optimize();
+        }
+        else
+        {
+            index->separateIndices.insert(index->separateIndices.end(),
+                                          index->mergedIndices.begin(),
+                                          index->mergedIndices.end());
+            index->mergedIndices.clear();
+            index->mergedRegex = QRegularExpression();
+        }
+    }
+
+    std::atomic_store(&this->blockIndex_,
+                      std::shared_ptr<const BlockIndex>(std::move(index)));
+}
+
 }  // namespace chatterino
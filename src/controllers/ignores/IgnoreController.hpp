@@ -4,6 +4,11 @@
 #include "common/SignalVector.hpp"
 #include "common/Singleton.hpp"
 #include "controllers/ignores/IgnorePhrase.hpp"
+#include "util/PhraseAutomaton.hpp"
+
+#include <boost/optional.hpp>
+
+#include <memory>
 
 namespace chatterino {
 
@@ -21,11 +26,42 @@ public:
 
     IgnoreModel *createModel(QObject *parent);
 
+    // The checks below can be called from any thread.
+
+    // returns a block phrase that matches the message, if there is one
+    boost::optional<IgnorePhrase> findBlockingPhrase(
+        const QString &message) const;
+    bool isBlockedUser(const QString &userId) const;
+
 private:
+    // Index over the phrases that block messages. Literal phrases live in
+    // one automaton per case sensitivity, regexes are merged into a single
+    // alternation. Rebuilt from scratch when the phrases change.
+    struct BlockIndex {
+        BlockIndex();
+
+        std::vector<IgnorePhrase> phrases;
+
+        PhraseAutomaton caseSensitive;
+        PhraseAutomaton caseInsensitive;
+
+        QRegularExpression mergedRegex;
+        // phrase index for every capture group of mergedRegex
+        std::vector<int> mergedIndices;
+
+        // regexes with capture groups would break the merged group numbers
+        std::vector<int> separateIndices;
+    };
+
+    void rebuildBlockIndex();
+
     bool initialized_ = false;
 
     ChatterinoSetting<std::vector<IgnorePhrase>> ignoresSetting_ = {
         "/ignore/phrases"};
+
+    std::shared_ptr<const BlockIndex> blockIndex_ =
+        std::make_shared<const BlockIndex>();
 };
 
 }  // namespace chatterino
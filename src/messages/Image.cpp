@@ -6,21 +6,49 @@
 #include "debug/AssertInGuiThread.hpp"
 #include "debug/Benchmark.hpp"
 #include "debug/Log.hpp"
+#include "messages/ImageDecodeQueue.hpp"
 #include "singletons/Emotes.hpp"
-#include "singletons/WindowManager.hpp"
+#include "singletons/Settings.hpp"
 #include "util/DebugCount.hpp"
-#include "util/PostToThread.hpp"
 
-#include <QBuffer>
-#include <QImageReader>
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QTimer>
+#include <algorithm>
 #include <functional>
 #include <thread>
 
 namespace chatterino {
+namespace {
+    // images painted within this time are never evicted
+    const qint64 recentlyUsedTime = 10000;
+
+    // bytes used by the pixmaps of all frames, only used on the gui thread
+    int64_t imageMemoryUsage = 0;
+
+    // monotonic time in milliseconds
+    qint64 currentTime()
+    {
+        static QElapsedTimer timer = [] {
+            QElapsedTimer timer;
+            timer.start();
+            return timer;
+        }();
+
+        return timer.elapsed();
+    }
+
+    // images with frames that can be loaded again from the url
+    std::vector<std::weak_ptr<Image>> &evictableImages()
+    {
+        static std::vector<std::weak_ptr<Image>> images;
+        return images;
+    }
+}  // namespace
+
 namespace detail {
     // Frames
     Frames::Frames()
@@ -34,13 +62,28 @@ namespace detail {
         assertInGuiThread();
         DebugCount::increase("images");
 
+        for (const auto &frame : this->items_)
+        {
+            this->memoryUsage_ += int64_t(frame.image.width()) *
+                                  frame.image.height() *
+                                  frame.image.depth() / 8;
+        }
+
+        imageMemoryUsage += this->memoryUsage_;
+        DebugCount::increase("image memory (KB)", this->memoryUsage_ / 1024);
+
         if (this->animated())
         {
             DebugCount::increase("animated images");
 
-            this->gifTimerConnection_ =
-                getApp()->emotes->gifTimer.signal.connect(
-                    [this] { this->advance(); });
+            this->endTimes_.reserve(size_t(this->items_.size()));
+
+            int64_t time = 0;
+            for (const auto &frame : this->items_)
+            {
+                time += frame.duration;
+                this->endTimes_.push_back(time);
+            }
         }
     }
 
@@ -49,37 +92,13 @@ namespace detail {
         assertInGuiThread();
         DebugCount::decrease("images");
 
+        imageMemoryUsage -= this->memoryUsage_;
+        DebugCount::decrease("image memory (KB)", this->memoryUsage_ / 1024);
+
         if (this->animated())
         {
             DebugCount::decrease("animated images");
         }
-
-        this->gifTimerConnection_.disconnect();
-    }
-
-    void Frames::advance()
-    {
-        this->durationOffset_ += GIF_FRAME_LENGTH;
-
-        while (true)
-        {
-            this->index_ %= this->items_.size();
-
-            // TODO: Figure out what this was supposed to achieve
-            // if (this->index_ >= this->items_.size()) {
-            //     this->index_ = this->index_;
-            // }
-
-            if (this->durationOffset_ > this->items_[this->index_].duration)
-            {
-                this->durationOffset_ -= this->items_[this->index_].duration;
-                this->index_ = (this->index_ + 1) % this->items_.size();
-            }
-            else
-            {
-                break;
-            }
-        }
     }
 
     bool Frames::animated() const
@@ -91,7 +110,17 @@ namespace detail {
     {
         if (this->items_.size() == 0)
             return boost::none;
-        return this->items_[this->index_].image;
+        if (!this->animated())
+            return this->items_.front().image;
+
+        // all animations share the same clock, so the frame can be looked up
+        // when it is painted instead of advancing every frame on every tick
+        auto time =
+            getApp()->emotes->gifTimer.position() % this->endTimes_.back();
+        auto it = std::upper_bound(this->endTimes_.begin(),
+                                   this->endTimes_.end(), time);
+
+        return this->items_[int(it - this->endTimes_.begin())].image;
     }
 
     boost::optional<QPixmap> Frames::first() const
@@ -101,99 +130,9 @@ namespace detail {
         return this->items_.front().image;
     }
 
-    // functions
-    QVector<Frame<QImage>> readFrames(QImageReader &reader, const Url &url)
+    int64_t Frames::memoryUsage() const
     {
-        QVector<Frame<QImage>> frames;
-
-        if (reader.imageCount() == 0)
-        {
-            log("Error while reading image {}: '{}'", url.string,
-                reader.errorString());
-            return frames;
-        }
-
-        QImage image;
-        for (int index = 0; index < reader.imageCount(); ++index)
-        {
-            if (reader.read(&image))
-            {
-                QPixmap::fromImage(image);
-
-                int duration = std::max(20, reader.nextImageDelay());
-                frames.push_back(Frame<QImage>{image, duration});
-            }
-        }
-
-        if (frames.size() == 0)
-        {
-            log("Error while reading image {}: '{}'", url.string,
-                reader.errorString());
-        }
-
-        return frames;
-    }
-
-    // parsed
-    template <typename Assign>
-    void assignDelayed(
-        std::queue<std::pair<Assign, QVector<Frame<QPixmap>>>> &queued,
-        std::mutex &mutex, std::atomic_bool &loadedEventQueued)
-    {
-        std::lock_guard<std::mutex> lock(mutex);
-        int i = 0;
-
-        while (!queued.empty())
-        {
-            queued.front().first(queued.front().second);
-            queued.pop();
-
-            if (++i > 50)
-            {
-                QTimer::singleShot(3, [&] {
-                    assignDelayed(queued, mutex, loadedEventQueued);
-                });
-                return;
-            }
-        }
-
-        getApp()->windows->forceLayoutChannelViews();
-        loadedEventQueued = false;
-    }
-
-    template <typename Assign>
-    auto makeConvertCallback(const QVector<Frame<QImage>> &parsed,
-                             Assign assign)
-    {
-        return [parsed, assign] {
-            // convert to pixmap
-            auto frames = QVector<Frame<QPixmap>>();
-            std::transform(parsed.begin(), parsed.end(),
-                           std::back_inserter(frames), [](auto &frame) {
-                               return Frame<QPixmap>{
-                                   QPixmap::fromImage(frame.image),
-                                   frame.duration};
-                           });
-
-            // put into stack
-            static std::queue<std::pair<Assign, QVector<Frame<QPixmap>>>>
-                queued;
-            static std::mutex mutex;
-
-            std::lock_guard<std::mutex> lock(mutex);
-            queued.emplace(assign, frames);
-
-            static std::atomic_bool loadedEventQueued{false};
-
-            if (!loadedEventQueued)
-            {
-                loadedEventQueued = true;
-
-                QTimer::singleShot(100, [=] {
-                    assignDelayed(queued, mutex, loadedEventQueued);
-                });
-            }
-        };
+        return this->memoryUsage_;
     }
 }  // namespace detail
 
@@ -202,9 +141,24 @@ ImagePtr Image::fromUrl(const Url &url, qreal scale)
 {
     static std::unordered_map<Url, std::weak_ptr<Image>> cache;
     static std::mutex mutex;
+    static size_t pruneAt = 1024;
 
     std::lock_guard<std::mutex> lock(mutex);
 
+    // drop the entries of destroyed images once in a while
+    if (cache.size() >= pruneAt)
+    {
+        for (auto it = cache.begin(); it != cache.end();)
+        {
+            if (it->second.expired())
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+
+        pruneAt = std::max<size_t>(1024, cache.size() * 2);
+    }
+
     auto shared = cache[url].lock();
 
     if (!shared)
@@ -241,6 +195,10 @@ Image::Image(const Url &url, qreal scale)
     , shouldLoad_(true)
     , frames_(std::make_unique<detail::Frames>())
 {
+    // Images can be created while building messages on a worker thread.
+    // object_ receives the network replies, so it has to live on a thread
+    // with an event loop.
+    this->object_.moveToThread(QCoreApplication::instance()->thread());
 }
 
 Image::Image(const QPixmap &pixmap, qreal scale)
@@ -259,6 +217,8 @@ boost::optional<QPixmap> Image::pixmap() const
 {
     assertInGuiThread();
 
+    this->lastUsed_ = currentTime();
+
     if (this->shouldLoad_)
     {
         const_cast<Image *>(this)->shouldLoad_ = false;
@@ -291,6 +251,8 @@ int Image::width() const
 
     if (auto pixmap = this->frames_->first())
         return pixmap->width() * this->scale_;
+    else if (this->evictedSize_.isValid())
+        return this->evictedSize_.width() * this->scale_;
     else
         return 16;
 }
@@ -301,6 +263,8 @@ int Image::height() const
 
     if (auto pixmap = this->frames_->first())
         return pixmap->height() * this->scale_;
+    else if (this->evictedSize_.isValid())
+        return this->evictedSize_.height() * this->scale_;
     else
         return 16;
 }
@@ -308,26 +272,15 @@ int Image::height() const
 void Image::load()
 {
     NetworkRequest req(this->url().string);
-    req.setExecuteConcurrently(true);
     req.setCaller(&this->object_);
     req.setUseQuickLoadCache(true);
-    req.onSuccess([that = this, weak = weakOf(this)](auto result) -> Outcome {
+    req.onSuccess([weak = weakOf(this)](auto result) -> Outcome {
         auto shared = weak.lock();
         if (!shared)
             return Failure;
 
-        auto data = result.getData();
-
-        // const cast since we are only reading from it
-        QBuffer buffer(const_cast<QByteArray *>(&data));
-        buffer.open(QIODevice::ReadOnly);
-        QImageReader reader(&buffer);
-        auto parsed = detail::readFrames(reader, that->url());
-
-        postToThread(makeConvertCallback(parsed, [weak](auto frames) {
-            if (auto shared = weak.lock())
-                shared->frames_ = std::make_unique<detail::Frames>(frames);
-        }));
+        // the frames are set once the decode threads got to the image
+        ImageDecodeQueue::getInstance().push(shared, result.getData());
 
         return Success;
     });
@@ -344,6 +297,116 @@ void Image::load()
     req.execute();
 }
 
+void Image::setFrames(std::unique_ptr<detail::Frames> frames)
+{
+    assertInGuiThread();
+
+    this->frames_ = std::move(frames);
+    this->evictedSize_ = QSize();
+
+    if (!this->evictable_ && !this->url_.string.isEmpty() &&
+        this->frames_->first())
+    {
+        this->evictable_ = true;
+        evictableImages().push_back(weakOf(this));
+
+        Image::queueMemoryCheck();
+    }
+}
+
+void Image::evictFrames()
+{
+    assertInGuiThread();
+
+    if (auto pixmap = this->frames_->first())
+    {
+        this->evictedSize_ = pixmap->size();
+    }
+
+    // pixmap() loads them again from the (disk cached) url
+    this->frames_ = std::make_unique<detail::Frames>();
+    this->shouldLoad_ = true;
+    this->evictable_ = false;
+
+    DebugCount::increase("image evictions");
+}
+
+void Image::queueMemoryCheck()
+{
+    static bool queued = false;
+
+    if (queued)
+        return;
+
+    // images tend to finish loading in bursts
+    queued = true;
+    QTimer::singleShot(1000, [] {
+        queued = false;
+        Image::checkMemory();
+    });
+}
+
+void Image::checkMemory()
+{
+    assertInGuiThread();
+
+    auto limit =
+        int64_t(getSettings()->imageMemoryLimit.getValue()) * 1024 * 1024;
+
+    auto &images = evictableImages();
+
+    // images that are gone are dropped even when there's nothing to evict,
+    // otherwise the list grows with every image that was ever loaded
+    images.erase(std::remove_if(images.begin(), images.end(),
+                                [](const auto &weak) {
+                                    return weak.expired();
+                                }),
+                 images.end());
+
+    if (imageMemoryUsage <= limit)
+        return;
+
+    std::vector<ImagePtr> candidates;
+    candidates.reserve(images.size());
+
+    for (const auto &weak : images)
+    {
+        if (auto shared = weak.lock())
+        {
+            if (shared->evictable_)
+                candidates.push_back(std::move(shared));
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto &a, const auto &b) {
+                  return a->lastUsed_ < b->lastUsed_;
+              });
+
+    // stop a bit below the limit, so we don't end up here after every load
+    auto target = limit / 10 * 9;
+    auto now = currentTime();
+
+    for (const auto &image : candidates)
+    {
+        if (imageMemoryUsage <= target ||
+            now - image->lastUsed_ < recentlyUsedTime)
+        {
+            break;
+        }
+
+        image->evictFrames();
+    }
+
+    images.clear();
+
+    for (const auto &image : candidates)
+    {
+        if (image->evictable_)
+            images.push_back(image);
+    }
+}
+
 bool Image::operator==(const Image &other) const
 {
     if (this->isEmpty() && other.isEmpty())
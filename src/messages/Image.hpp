@@ -11,6 +11,7 @@
 #include <memory>
 #include <mutex>
 #include <pajlada/signals/signal.hpp>
+#include <vector>
 
 #include "common/Aliases.hpp"
 #include "common/NullablePtr.hpp"
@@ -30,15 +31,15 @@ namespace detail {
         ~Frames();
 
         bool animated() const;
-        void advance();
         boost::optional<QPixmap> current() const;
         boost::optional<QPixmap> first() const;
+        int64_t memoryUsage() const;
 
     private:
         QVector<Frame<QPixmap>> items_;
-        int index_{0};
-        int durationOffset_{0};
-        pajlada::Signals::Connection gifTimerConnection_;
+        // time at which each frame ends, relative to the start of the loop
+        std::vector<int64_t> endTimes_;
+        int64_t memoryUsage_{0};
     };
 }  // namespace detail
 
@@ -64,11 +65,20 @@ public:
     bool operator!=(const Image &image) const;
 
 private:
+    friend class ImageDecodeQueue;
+
     Image();
     Image(const Url &url, qreal scale);
     Image(const QPixmap &nonOwning, qreal scale);
 
     void load();
+    void setFrames(std::unique_ptr<detail::Frames> frames);
+    void evictFrames();
+
+    // drops the frames of images that weren't painted recently if the decoded
+    // images use more memory than allowed
+    static void queueMemoryCheck();
+    static void checkMemory();
 
     Url url_{};
     qreal scale_{1};
@@ -76,5 +86,11 @@ private:
     bool shouldLoad_{false};
     std::unique_ptr<detail::Frames> frames_{};
     QObject object_{};
+
+    // size of the evicted frames, so the layout doesn't change while they are
+    // loaded again
+    QSize evictedSize_{};
+    mutable qint64 lastUsed_{0};
+    bool evictable_{false};
 };
 }  // namespace chatterino
@@ -0,0 +1,194 @@
+#include "messages/ImageDecodeQueue.hpp"
+
+#include "Application.hpp"
+#include "debug/AssertInGuiThread.hpp"
+#include "debug/Log.hpp"
+#include "singletons/WindowManager.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QThread>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace chatterino {
+namespace {
+    // time the gui thread may spend converting images before it handles
+    // other events again
+    const qint64 deliveryBudget = 8;
+
+    QVector<detail::Frame<QImage>> readFrames(QImageReader &reader,
+                                              const Url &url)
+    {
+        QVector<detail::Frame<QImage>> frames;
+
+        if (reader.imageCount() == 0)
+        {
+            log("Error while reading image {}: '{}'", url.string,
+                reader.errorString());
+            return frames;
+        }
+
+        QImage image;
+        for (int index = 0; index < reader.imageCount(); ++index)
+        {
+            if (reader.read(&image))
+            {
+                int duration = std::max(20, reader.nextImageDelay());
+                frames.push_back(detail::Frame<QImage>{image, duration});
+            }
+        }
+
+        if (frames.size() == 0)
+        {
+            log("Error while reading image {}: '{}'", url.string,
+                reader.errorString());
+        }
+
+        return frames;
+    }
+}  // namespace
+
+ImageDecodeQueue &ImageDecodeQueue::getInstance()
+{
+    static ImageDecodeQueue instance;
+    return instance;
+}
+
+ImageDecodeQueue::ImageDecodeQueue()
+{
+    // leave a core for the gui thread
+    this->pool_.setMaxThreadCount(
+        std::max(1, QThread::idealThreadCount() - 1));
+}
+
+void ImageDecodeQueue::push(const ImagePtr &image, const QByteArray &data)
+{
+    assertInGuiThread();
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        this->pending_.push_back(
+            Job{image, image->url(), data, image->lastUsed_});
+    }
+
+    // every runnable decodes whatever image is the most important one once it
+    // gets to run
+    this->pool_.start(new LambdaRunnable([this] { this->decodeNext(); }));
+}
+
+void ImageDecodeQueue::decodeNext()
+{
+    Job job;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (this->pending_.empty())
+            return;
+
+        // priorities change while the jobs are waiting, so this is a linear
+        // search instead of a heap
+        auto it = std::max_element(
+            this->pending_.begin(), this->pending_.end(),
+            [](auto &a, auto &b) { return a.priority < b.priority; });
+
+        std::swap(*it, this->pending_.back());
+        job = std::move(this->pending_.back());
+        this->pending_.pop_back();
+    }
+
+    QBuffer buffer(&job.data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    auto frames = readFrames(reader, job.url);
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->decoded_.push_back(Result{std::move(job.image), std::move(frames)});
+
+    if (!this->deliveryQueued_)
+    {
+        this->deliveryQueued_ = true;
+        postToThread([this] { this->deliver(); });
+    }
+}
+
+// takes the priority from the last time the images were painted
+void ImageDecodeQueue::updatePriorities()
+{
+    assertInGuiThread();
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    for (auto &job : this->pending_)
+    {
+        if (auto image = job.image.lock())
+            job.priority = image->lastUsed_;
+    }
+}
+
+void ImageDecodeQueue::deliver()
+{
+    assertInGuiThread();
+
+    std::unordered_set<const Image *> loaded;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (true)
+    {
+        Result result;
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+
+            if (this->decoded_.empty())
+            {
+                this->deliveryQueued_ = false;
+                break;
+            }
+
+            // continue once the events that piled up have been handled
+            if (timer.elapsed() >= deliveryBudget)
+            {
+                postToThread([this] { this->deliver(); });
+                break;
+            }
+
+            result = std::move(this->decoded_.front());
+            this->decoded_.pop_front();
+        }
+
+        auto image = result.image.lock();
+        if (!image)
+            continue;
+
+        // pixmaps can only be created on the gui thread
+        QVector<detail::Frame<QPixmap>> frames;
+        frames.reserve(result.frames.size());
+
+        for (const auto &frame : result.frames)
+        {
+            frames.push_back(detail::Frame<QPixmap>{
+                QPixmap::fromImage(frame.image), frame.duration});
+        }
+
+        image->setFrames(std::make_unique<detail::Frames>(frames));
+        loaded.insert(image.get());
+    }
+
+    this->updatePriorities();
+
+    if (!loaded.empty())
+    {
+        getApp()->windows->layoutImages(loaded);
+    }
+}
+
+}  // namespace chatterino
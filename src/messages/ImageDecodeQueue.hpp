@@ -0,0 +1,59 @@
+#pragma once
+
+#include "messages/Image.hpp"
+
+#include <QByteArray>
+#include <QImage>
+#include <QThreadPool>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chatterino {
+
+// Decodes downloaded images on a pool of worker threads.
+//
+// The images that were painted most recently are decoded first, so emotes on
+// screen don't wait behind a backlog of images nobody is looking at. Decoded
+// images are handed to the gui thread in batches that only take a few
+// milliseconds each, after every batch the channel views lay out the messages
+// that contain one of the images again.
+class ImageDecodeQueue : boost::noncopyable
+{
+public:
+    static ImageDecodeQueue &getInstance();
+
+    // must be called from the gui thread
+    void push(const ImagePtr &image, const QByteArray &data);
+
+private:
+    struct Job {
+        std::weak_ptr<Image> image;
+        Url url;
+        QByteArray data;
+        qint64 priority = 0;
+    };
+
+    struct Result {
+        std::weak_ptr<Image> image;
+        QVector<detail::Frame<QImage>> frames;
+    };
+
+    ImageDecodeQueue();
+
+    void decodeNext();
+    void updatePriorities();
+    void deliver();
+
+    QThreadPool pool_;
+
+    std::mutex mutex_;
+    std::vector<Job> pending_;
+    std::deque<Result> decoded_;
+    bool deliveryQueued_ = false;
+};
+
+}  // namespace chatterino
@@ -4,15 +4,13 @@
 
 #include <QDebug>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
-#include <mutex>
 #include <vector>
 
 namespace chatterino {
 
-//
-// Warning:
-// - this class is so overengineered it's not even funny anymore
 //
 // Explanation:
 // - messages can be appended until 'limit' is reached
@@ -23,69 +21,87 @@ namespace chatterino {
 // - you are able to get a "Snapshot" which captures the state of this object
 // - adding items to this class does not change the "items" of the snapshot
 //
+// Implementation:
+// - items live in a ring buffer with room for at least 2 * limit items, so
+//   appending and removing from the start are O(1) and do not allocate
+// - only one thread (the gui thread) may modify the queue, snapshots can be
+//   taken from any thread without locking
+// - a snapshot pins the buffer it was taken from. Every 'limit' appends the
+//   queue checks if the buffer is pinned before it starts overwriting the
+//   slots of already removed items. If it is pinned the live items are moved
+//   to a fresh buffer and the old one is left to the snapshots.
+// - removed items are released right away unless a snapshot is around, then
+//   they are released once the queue sees no pins or moves to a new buffer
+// - pushFront copies the live items into a new buffer. replaceItem copies
+//   the buffer's chunk list and only the chunk holding the item, snapshots
+//   keep the old chunk.
+//
 
 template <typename T>
 class LimitedQueue
 {
 protected:
-    typedef std::shared_ptr<std::vector<T>> Chunk;
-    typedef std::shared_ptr<std::vector<Chunk>> ChunkVector;
+    using Buffer = detail::LimitedQueueBuffer<T>;
+    using BufferPtr = std::shared_ptr<Buffer>;
 
 public:
     LimitedQueue(size_t limit = 1000)
-        : limit_(limit)
+        : limit_(std::max<size_t>(limit, 1))
     {
         this->clear();
     }
 
     void clear()
     {
-        std::lock_guard<std::mutex> lock(this->mutex_);
-
-        this->chunks_ =
-            std::make_shared<std::vector<std::shared_ptr<std::vector<T>>>>();
-        Chunk chunk = std::make_shared<std::vector<T>>();
-        chunk->resize(this->chunkSize_);
-        this->chunks_->push_back(chunk);
-        this->firstChunkOffset_ = 0;
-        this->lastChunkEnd_ = 0;
+        this->publish(std::make_shared<Buffer>(this->capacity()), 0, 0);
     }
 
     // return true if an item was deleted
     // deleted will be set if the item was deleted
     bool pushBack(const T &item, T &deleted)
     {
-        std::lock_guard<std::mutex> lock(this->mutex_);
+        Buffer *buffer = this->buffer_.get();
 
-        Chunk lastChunk = this->chunks_->back();
+        size_t begin = buffer->begin.load(std::memory_order_relaxed);
+        size_t end = buffer->end.load(std::memory_order_relaxed);
 
-        // still space in the last chunk
-        if (lastChunk->size() <= this->lastChunkEnd_)
+        // about to reuse the slots of items that were removed a lap ago
+        if (end == this->nextPinCheck_)
         {
-            // create new chunk vector
-            ChunkVector newVector = std::make_shared<
-                std::vector<std::shared_ptr<std::vector<T>>>>();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            // copy chunks
-            for (Chunk &chunk : *this->chunks_)
+            if (buffer->pins->load() != 0)
             {
-                newVector->push_back(chunk);
+                buffer = this->copyLiveItems(begin, end);
             }
 
-            // push back new chunk
-            Chunk newChunk = std::make_shared<std::vector<T>>();
-            newChunk->resize(this->chunkSize_);
-            newVector->push_back(newChunk);
+            this->nextPinCheck_ = end + this->limit_;
+        }
+
+        buffer->at(end) = item;
+        buffer->end.store(end + 1, std::memory_order_release);
 
-            // replace current chunk vector
-            this->chunks_ = newVector;
-            this->lastChunkEnd_ = 0;
-            lastChunk = this->chunks_->back();
+        if (end + 1 - begin <= this->limit_)
+        {
+            return false;
         }
 
-        lastChunk->at(this->lastChunkEnd_++) = item;
+        deleted = buffer->at(begin);
+        buffer->begin.store(begin + 1, std::memory_order_release);
+
+        // snapshots taken from now on can't see the removed items, so they
+        // can be released if there are no older ones
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (buffer->pins->load() == 0)
+        {
+            for (; this->releasedUpTo_ <= begin; this->releasedUpTo_++)
+            {
+                buffer->at(this->releasedUpTo_) = T();
+            }
+        }
 
-        return this->deleteFirstItem(deleted);
+        return true;
     }
 
     // returns a vector with all the accepted items
@@ -93,87 +109,52 @@ public:
     {
         std::vector<T> acceptedItems;
 
-        if (this->space() > 0)
-        {
-            std::lock_guard<std::mutex> lock(this->mutex_);
-
-            // create new vector to clone chunks into
-            ChunkVector newChunks = std::make_shared<
-                std::vector<std::shared_ptr<std::vector<T>>>>();
-
-            newChunks->resize(this->chunks_->size());
+        size_t begin = this->buffer_->begin.load(std::memory_order_relaxed);
+        size_t end = this->buffer_->end.load(std::memory_order_relaxed);
 
-            // copy chunks except for first one
-            for (size_t i = 1; i < this->chunks_->size(); i++)
-            {
-                newChunks->at(i) = this->chunks_->at(i);
-            }
+        size_t offset = std::min(this->limit_ - (end - begin), items.size());
 
-            // create new chunk for the first one
-            size_t offset =
-                std::min(this->space(), static_cast<qsizetype>(items.size()));
-            Chunk newFirstChunk = std::make_shared<std::vector<T>>();
-            newFirstChunk->resize(this->chunks_->front()->size() + offset);
+        if (offset == 0)
+        {
+            return acceptedItems;
+        }
 
-            for (size_t i = 0; i < offset; i++)
-            {
-                newFirstChunk->at(i) = items[items.size() - offset + i];
-                acceptedItems.push_back(items[items.size() - offset + i]);
-            }
+        acceptedItems.reserve(offset);
 
-            for (size_t i = 0; i < this->chunks_->at(0)->size(); i++)
-            {
-                newFirstChunk->at(i + offset) = this->chunks_->at(0)->at(i);
-            }
+        // rebase the sequence numbers so that the new first item is 0
+        auto newBuffer = std::make_shared<Buffer>(this->capacity());
 
-            newChunks->at(0) = newFirstChunk;
+        for (size_t i = 0; i < offset; i++)
+        {
+            auto &item = items[items.size() - offset + i];
 
-            this->chunks_ = newChunks;
-            // qDebug() << acceptedItems.size();
-            // qDebug() << this->chunks->at(0)->size();
+            newBuffer->at(i) = item;
+            acceptedItems.push_back(item);
+        }
 
-            if (this->chunks_->size() == 1)
-            {
-                this->lastChunkEnd_ += offset;
-            }
+        for (size_t i = begin; i < end; i++)
+        {
+            newBuffer->at(offset + i - begin) = this->buffer_->at(i);
         }
 
+        this->publish(std::move(newBuffer), 0, offset + end - begin);
+
         return acceptedItems;
     }
 
     // replace an single item, return index if successful, -1 if unsuccessful
     int replaceItem(const T &item, const T &replacement)
     {
-        std::lock_guard<std::mutex> lock(this->mutex_);
+        size_t begin = this->buffer_->begin.load(std::memory_order_relaxed);
+        size_t end = this->buffer_->end.load(std::memory_order_relaxed);
 
-        int x = 0;
-
-        for (size_t i = 0; i < this->chunks_->size(); i++)
+        for (size_t i = begin; i < end; i++)
         {
-            Chunk &chunk = this->chunks_->at(i);
-
-            size_t start = i == 0 ? this->firstChunkOffset_ : 0;
-            size_t end =
-                i == chunk->size() - 1 ? this->lastChunkEnd_ : chunk->size();
-
-            for (size_t j = start; j < end; j++)
+            if (this->buffer_->at(i) == item)
             {
-                if (chunk->at(j) == item)
-                {
-                    Chunk newChunk = std::make_shared<std::vector<T>>();
-                    newChunk->resize(chunk->size());
-
-                    for (size_t k = 0; k < chunk->size(); k++)
-                    {
-                        newChunk->at(k) = chunk->at(k);
-                    }
-
-                    newChunk->at(j) = replacement;
-                    this->chunks_->at(i) = newChunk;
-
-                    return x;
-                }
-                x++;
+                this->replaceAt(i, replacement);
+
+                return int(i - begin);
             }
         }
 
@@ -183,114 +164,97 @@ public:
     // replace an item at index, return true if worked
     bool replaceItem(size_t index, const T &replacement)
     {
-        std::lock_guard<std::mutex> lock(this->mutex_);
+        size_t begin = this->buffer_->begin.load(std::memory_order_relaxed);
+        size_t end = this->buffer_->end.load(std::memory_order_relaxed);
 
-        size_t x = 0;
-
-        for (size_t i = 0; i < this->chunks_->size(); i++)
+        if (index >= end - begin)
         {
-            Chunk &chunk = this->chunks_->at(i);
+            return false;
+        }
+
+        this->replaceAt(begin + index, replacement);
 
-            size_t start = i == 0 ? this->firstChunkOffset_ : 0;
-            size_t end =
-                i == chunk->size() - 1 ? this->lastChunkEnd_ : chunk->size();
+        return true;
+    }
 
-            for (size_t j = start; j < end; j++)
+    LimitedQueueSnapshot<T> getSnapshot()
+    {
+        while (true)
+        {
+            auto buffer = std::atomic_load(&this->buffer_);
+            LimitedQueueSnapshot<T> snapshot(buffer, this->limit_);
+
+            // A buffer that got replaced before it was pinned shares chunks
+            // with the current one but not its range, so it might show items
+            // that were released already. Once pinned, a current buffer is
+            // safe.
+            if (std::atomic_load(&this->buffer_) == buffer)
             {
-                if (x == index)
-                {
-                    Chunk newChunk = std::make_shared<std::vector<T>>();
-                    newChunk->resize(chunk->size());
-
-                    for (size_t k = 0; k < chunk->size(); k++)
-                    {
-                        newChunk->at(k) = chunk->at(k);
-                    }
-
-                    newChunk->at(j) = replacement;
-                    this->chunks_->at(i) = newChunk;
-
-                    return true;
-                }
-                x++;
+                return snapshot;
             }
         }
-        return false;
     }
 
-    //    void insertAfter(const std::vector<T> &items, const T &index)
-
-    LimitedQueueSnapshot<T> getSnapshot()
+private:
+    size_t capacity() const
     {
-        std::lock_guard<std::mutex> lock(this->mutex_);
-
-        return LimitedQueueSnapshot<T>(
-            this->chunks_, this->limit_ - this->space(),
-            this->firstChunkOffset_, this->lastChunkEnd_);
+        return this->limit_ * 2;
     }
 
-private:
-    qsizetype space()
+    // Moves the live items into a buffer nobody else can see yet. The item
+    // sequence numbers stay the same.
+    Buffer *copyLiveItems(size_t begin, size_t end)
     {
-        size_t totalSize = 0;
-        for (Chunk &chunk : *this->chunks_)
-        {
-            totalSize += chunk->size();
-        }
+        auto newBuffer = std::make_shared<Buffer>(this->capacity());
 
-        totalSize -= this->chunks_->back()->size() - this->lastChunkEnd_;
-        if (this->chunks_->size() != 1)
+        for (size_t i = begin; i < end; i++)
         {
-            totalSize -= this->firstChunkOffset_;
+            newBuffer->at(i) = this->buffer_->at(i);
         }
 
-        return this->limit_ - totalSize;
+        this->publish(std::move(newBuffer), begin, end);
+
+        return this->buffer_.get();
     }
 
-    bool deleteFirstItem(T &deleted)
+    // Publishes a buffer that shares everything but the chunk holding
+    // sequence with the current one. The pins are shared as well, so the
+    // pin checks keep covering the snapshots of the old buffer.
+    void replaceAt(size_t sequence, const T &replacement)
     {
-        // determine if the first chunk should be deleted
-        if (space() > 0)
-        {
-            return false;
-        }
-
-        deleted = this->chunks_->front()->at(this->firstChunkOffset_);
-
-        this->firstChunkOffset_++;
+        auto newBuffer = std::make_shared<Buffer>(*this->buffer_);
 
-        // need to delete the first chunk
-        if (this->firstChunkOffset_ == this->chunks_->front()->size() - 1)
-        {
-            // copy the chunk vector
-            ChunkVector newVector = std::make_shared<
-                std::vector<std::shared_ptr<std::vector<T>>>>();
+        newBuffer->detachChunk(sequence);
+        newBuffer->at(sequence) = replacement;
 
-            // delete first chunk
-            bool first = true;
-            for (Chunk &chunk : *this->chunks_)
-            {
-                if (!first)
-                {
-                    newVector->push_back(chunk);
-                }
-                first = false;
-            }
+        newBuffer->begin.store(
+            this->buffer_->begin.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        newBuffer->end.store(
+            this->buffer_->end.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
 
-            this->chunks_ = newVector;
-            this->firstChunkOffset_ = 0;
-        }
-        return true;
+        std::atomic_store(&this->buffer_, std::move(newBuffer));
     }
 
-    ChunkVector chunks_;
-    std::mutex mutex_;
+    void publish(BufferPtr buffer, size_t begin, size_t end)
+    {
+        buffer->begin.store(begin, std::memory_order_relaxed);
+        buffer->end.store(end, std::memory_order_relaxed);
+
+        // snapshots taken from the new buffer can not see anything below
+        // 'end - limit', so the slots up to 'end + limit' are safe to write
+        this->nextPinCheck_ = end + this->limit_;
+        this->releasedUpTo_ = begin;
 
-    size_t firstChunkOffset_;
-    size_t lastChunkEnd_;
-    size_t limit_;
+        std::atomic_store(&this->buffer_, std::move(buffer));
+    }
 
-    const size_t chunkSize_ = 100;
+    BufferPtr buffer_;
+    size_t nextPinCheck_ = 0;
+    // removed items below this were reset in the current buffer
+    size_t releasedUpTo_ = 0;
+    const size_t limit_;
 };
 
 }  // namespace chatterino
@@ -1,60 +1,190 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <vector>
 
 namespace chatterino {
+namespace detail {
+
+    // Fixed size ring of items, stored in chunks. Items are addressed by a
+    // monotonically increasing sequence number, the live items are
+    // [begin, end).
+    //
+    // The buffer is only ever written by the thread owning the LimitedQueue.
+    // Snapshots "pin" the buffer while they are alive. The owner checks the
+    // pins before it starts reusing slots and moves to a fresh buffer if
+    // someone could still be reading them.
+    //
+    // A copy shares the chunks and the pin count with the original, so
+    // replacing an item only has to copy the chunk it is in.
+    template <typename T>
+    struct LimitedQueueBuffer {
+        static constexpr size_t chunkSize = 64;
+        using Chunk = std::vector<T>;
+
+        // the capacity is rounded up to whole chunks
+        explicit LimitedQueueBuffer(size_t minCapacity)
+            : chunks((minCapacity + chunkSize - 1) / chunkSize)
+            , pins(std::make_shared<std::atomic<size_t>>(0))
+        {
+            for (auto &chunk : this->chunks)
+            {
+                chunk = std::make_shared<Chunk>(chunkSize);
+            }
+        }
+
+        LimitedQueueBuffer(const LimitedQueueBuffer &other)
+            : chunks(other.chunks)
+            , pins(other.pins)
+        {
+        }
+
+        size_t capacity() const
+        {
+            return this->chunks.size() * chunkSize;
+        }
+
+        T &at(size_t sequence)
+        {
+            auto slot = sequence % this->capacity();
+            return (*this->chunks[slot / chunkSize])[slot % chunkSize];
+        }
+
+        const T &at(size_t sequence) const
+        {
+            auto slot = sequence % this->capacity();
+            return (*this->chunks[slot / chunkSize])[slot % chunkSize];
+        }
+
+        // gives this buffer its own copy of the chunk holding sequence
+        void detachChunk(size_t sequence)
+        {
+            auto &chunk =
+                this->chunks[sequence % this->capacity() / chunkSize];
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        std::atomic<size_t> begin{0};
+        std::atomic<size_t> end{0};
+        // shared by all buffers that share chunks
+        std::shared_ptr<std::atomic<size_t>> pins;
+    };
+
+}  // namespace detail
 
 template <typename T>
 class LimitedQueueSnapshot
 {
+    using Buffer = detail::LimitedQueueBuffer<T>;
+
 public:
     LimitedQueueSnapshot() = default;
 
-    LimitedQueueSnapshot(
-        std::shared_ptr<std::vector<std::shared_ptr<std::vector<T>>>> chunks,
-        size_t length, size_t firstChunkOffset, size_t lastChunkEnd)
-        : chunks_(chunks)
-        , length_(length)
-        , firstChunkOffset_(firstChunkOffset)
-        , lastChunkEnd_(lastChunkEnd)
+    LimitedQueueSnapshot(std::shared_ptr<Buffer> buffer, size_t limit)
+        : buffer_(std::move(buffer))
+    {
+        if (!this->buffer_)
+        {
+            return;
+        }
+
+        // pin before reading the range so the owner either sees the pin or
+        // we see the range it published after its last check
+        this->buffer_->pins->fetch_add(1);
+
+        size_t end = this->buffer_->end.load();
+        size_t begin = this->buffer_->begin.load();
+
+        if (begin > end)
+        {
+            begin = end;
+        }
+        if (end - begin > limit)
+        {
+            begin = end - limit;
+        }
+
+        this->begin_ = begin;
+        this->length_ = end - begin;
+    }
+
+    LimitedQueueSnapshot(const LimitedQueueSnapshot &other)
+        : buffer_(other.buffer_)
+        , begin_(other.begin_)
+        , length_(other.length_)
     {
+        if (this->buffer_)
+        {
+            this->buffer_->pins->fetch_add(1);
+        }
     }
 
-    std::size_t getLength()
+    LimitedQueueSnapshot(LimitedQueueSnapshot &&other) noexcept
+        : buffer_(std::move(other.buffer_))
+        , begin_(other.begin_)
+        , length_(other.length_)
     {
-        return this->length_;
+        other.begin_ = 0;
+        other.length_ = 0;
     }
 
-    T const &operator[](std::size_t index) const
+    LimitedQueueSnapshot &operator=(const LimitedQueueSnapshot &other)
     {
-        index += this->firstChunkOffset_;
+        if (this != &other)
+        {
+            LimitedQueueSnapshot copy(other);
+            this->swap(copy);
+        }
 
-        size_t x = 0;
+        return *this;
+    }
 
-        for (size_t i = 0; i < this->chunks_->size(); i++)
+    LimitedQueueSnapshot &operator=(LimitedQueueSnapshot &&other) noexcept
+    {
+        if (this != &other)
         {
-            auto &chunk = this->chunks_->at(i);
+            LimitedQueueSnapshot moved(std::move(other));
+            this->swap(moved);
+        }
 
-            if (x <= index && x + chunk->size() > index)
-            {
-                return chunk->at(index - x);
-            }
-            x += chunk->size();
+        return *this;
+    }
+
+    ~LimitedQueueSnapshot()
+    {
+        if (this->buffer_)
+        {
+            this->buffer_->pins->fetch_sub(1);
         }
+    }
 
-        assert(false && "out of range");
+    std::size_t getLength() const
+    {
+        return this->length_;
+    }
+
+    T const &operator[](std::size_t index) const
+    {
+        assert(index < this->length_ && "out of range");
 
-        return this->chunks_->at(0)->at(0);
+        return this->buffer_->at(this->begin_ + index);
     }
 
 private:
-    std::shared_ptr<std::vector<std::shared_ptr<std::vector<T>>>> chunks_;
+    void swap(LimitedQueueSnapshot &other) noexcept
+    {
+        std::swap(this->buffer_, other.buffer_);
+        std::swap(this->begin_, other.begin_);
+        std::swap(this->length_, other.length_);
+    }
+
+    std::shared_ptr<Buffer> buffer_;
 
+    size_t begin_ = 0;
     size_t length_ = 0;
-    size_t firstChunkOffset_ = 0;
-    size_t lastChunkEnd_ = 0;
 };
 
 }  // namespace chatterino
@@ -0,0 +1,120 @@
+#include "messages/MessageBuildQueue.hpp"
+
+#include "debug/AssertInGuiThread.hpp"
+#include "util/PostToThread.hpp"
+
+#include <QThread>
+
+#include <algorithm>
+#include <vector>
+
+namespace chatterino {
+
+MessageBuildQueue &MessageBuildQueue::getInstance()
+{
+    static MessageBuildQueue instance;
+    return instance;
+}
+
+MessageBuildQueue::MessageBuildQueue()
+{
+    // leave a core for the gui thread
+    this->pool_.setMaxThreadCount(
+        std::max(1, QThread::idealThreadCount() - 1));
+}
+
+void MessageBuildQueue::push(BuildFunction build, FinishFunction finish)
+{
+    assertInGuiThread();
+
+    auto job = std::make_shared<Job>();
+    job->build = std::move(build);
+    job->finish = std::move(finish);
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->jobs_.push_back(job);
+
+    this->pool_.start(new LambdaRunnable([this, job] {
+        auto result = job->build();
+
+        // release everything the build function captured on this thread
+        job->build = nullptr;
+
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        job->result = std::move(result);
+        job->done = true;
+
+        this->queueDelivery();
+    }));
+}
+
+void MessageBuildQueue::runAfterPending(std::function<void()> function)
+{
+    assertInGuiThread();
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+
+    if (this->jobs_.empty())
+    {
+        lock.unlock();
+        function();
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->finish = [function = std::move(function)](MessagePtr) {
+        function();
+    };
+    job->done = true;
+
+    this->jobs_.push_back(job);
+    this->queueDelivery();
+}
+
+// mutex_ must be locked
+void MessageBuildQueue::queueDelivery()
+{
+    if (this->deliveryQueued_ || this->jobs_.empty() ||
+        !this->jobs_.front()->done)
+    {
+        return;
+    }
+
+    this->deliveryQueued_ = true;
+
+    postToThread([this] { this->deliver(); });
+}
+
+void MessageBuildQueue::deliver()
+{
+    std::vector<std::shared_ptr<Job>> finished;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        while (!this->jobs_.empty() && this->jobs_.front()->done)
+        {
+            finished.push_back(std::move(this->jobs_.front()));
+            this->jobs_.pop_front();
+        }
+
+        this->deliveryQueued_ = false;
+    }
+
+    for (auto &job : finished)
+    {
+        // the pool runnable might outlive this and hold the last reference to
+        // the job, what finish captured has to be released here
+        auto finish = std::move(job->finish);
+        job->finish = nullptr;
+        finish(std::move(job->result));
+    }
+
+    // a job that was finished while we were delivering might still be waiting
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->queueDelivery();
+}
+
+}  // namespace chatterino
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QThreadPool>
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace chatterino {
+
+struct Message;
+using MessagePtr = std::shared_ptr<const Message>;
+
+// Builds messages on a pool of worker threads and hands them back to the gui
+// thread in the same order they were pushed.
+//
+// The build function must only touch state that is safe to read from other
+// threads. The finish function is called on the gui thread with the result of
+// the build function, which may be nullptr.
+class MessageBuildQueue : boost::noncopyable
+{
+public:
+    using BuildFunction = std::function<MessagePtr()>;
+    using FinishFunction = std::function<void(MessagePtr)>;
+
+    static MessageBuildQueue &getInstance();
+
+    // must be called from the gui thread
+    void push(BuildFunction build, FinishFunction finish);
+
+    // runs the function on the gui thread once all messages that were pushed
+    // before have been finished, or right away if nothing is pending
+    void runAfterPending(std::function<void()> function);
+
+private:
+    struct Job {
+        BuildFunction build;
+        FinishFunction finish;
+        MessagePtr result;
+        bool done = false;
+    };
+
+    MessageBuildQueue();
+
+    void queueDelivery();
+    void deliver();
+
+    QThreadPool pool_;
+
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<Job>> jobs_;
+    bool deliveryQueued_ = false;
+};
+
+}  // namespace chatterino
@@ -9,6 +9,7 @@
 #include "singletons/Theme.hpp"
 #include "util/FormatTime.hpp"
 #include "util/IrcHelpers.hpp"
+#include "util/StringInterner.hpp"
 
 #include <QDateTime>
 
@@ -87,7 +88,7 @@ MessageBuilder::MessageBuilder(TimeoutMessageTag, const QString &username,
     this->message().flags.set(MessageFlag::System);
     this->message().flags.set(MessageFlag::Timeout);
     this->message().flags.set(MessageFlag::DoNotTriggerNotification);
-    this->message().timeoutUser = username;
+    this->message().timeoutUser = internString(username);
     this->emplace<TimestampElement>();
     this->emplace<TextElement>(text, MessageElementFlag::Text,
                                MessageColor::System);
@@ -100,7 +101,7 @@ MessageBuilder::MessageBuilder(const BanAction &action, uint32_t count)
     this->emplace<TimestampElement>();
     this->message().flags.set(MessageFlag::System);
     this->message().flags.set(MessageFlag::Timeout);
-    this->message().timeoutUser = action.target.name;
+    this->message().timeoutUser = internString(action.target.name);
     this->message().count = count;
 
     QString text;
@@ -157,7 +158,7 @@ MessageBuilder::MessageBuilder(const UnbanAction &action)
     this->message().flags.set(MessageFlag::System);
     this->message().flags.set(MessageFlag::Untimeout);
 
-    this->message().timeoutUser = action.target.name;
+    this->message().timeoutUser = internString(action.target.name);
 
     QString text;
 
@@ -89,8 +89,10 @@ void ImageElement::addToContainer(MessageLayoutContainer &container,
         auto size = QSize(this->image_->width() * container.getScale(),
                           this->image_->height() * container.getScale());
 
-        container.addElement((new ImageLayoutElement(*this, this->image_, size))
-                                 ->setLink(this->getLink()));
+        container.addElement(
+            container
+                .createElement<ImageLayoutElement>(*this, this->image_, size)
+                ->setLink(this->getLink()));
     }
 }
 
@@ -99,9 +101,6 @@ EmoteElement::EmoteElement(const EmotePtr &emote, MessageElementFlags flags)
     : MessageElement(flags)
     , emote_(emote)
 {
-    this->textElement_.reset(
-        new TextElement(emote->getCopyString(), MessageElementFlag::Misc));
-
     this->setTooltip(emote->tooltip.string);
 }
 
@@ -130,16 +129,21 @@ void EmoteElement::addToContainer(MessageLayoutContainer &container,
                 QSize(int(container.getScale() * image->width() * emoteScale),
                       int(container.getScale() * image->height() * emoteScale));
 
-            container.addElement((new ImageLayoutElement(*this, image, size))
-                                     ->setLink(this->getLink()));
+            container.addElement(
+                container.createElement<ImageLayoutElement>(*this, image, size)
+                    ->setLink(this->getLink()));
         }
         else
         {
-            if (this->textElement_)
+            // only needed when emotes are shown as text, which is rare
+            if (!this->textElement_)
             {
-                this->textElement_->addToContainer(container,
-                                                   MessageElementFlag::Misc);
+                this->textElement_.reset(new TextElement(
+                    this->emote_->getCopyString(), MessageElementFlag::Misc));
             }
+
+            this->textElement_->addToContainer(container,
+                                               MessageElementFlag::Misc);
         }
     }
 }
@@ -151,6 +155,14 @@ TextElement::TextElement(const QString &text, MessageElementFlags flags,
     , color_(color)
     , style_(style)
 {
+    // a single word keeps sharing the string it came from, e.g. an interned
+    // user name
+    if (!text.contains(' '))
+    {
+        this->words_.push_back({text, -1});
+        return;
+    }
+
     for (const auto &word : text.split(' '))
     {
         this->words_.push_back({word, -1});
@@ -168,6 +180,18 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
         QFontMetrics metrics =
             app->fonts->getFontMetrics(this->style_, container.getScale());
 
+        if (this->wordWidthsScale_ != container.getScale() ||
+            this->wordWidthsGeneration_ != app->fonts->getGeneration())
+        {
+            for (Word &word : this->words_)
+            {
+                word.width = -1;
+            }
+
+            this->wordWidthsScale_ = container.getScale();
+            this->wordWidthsGeneration_ = app->fonts->getGeneration();
+        }
+
         for (Word &word : this->words_)
         {
             auto getTextLayoutElement = [&](QString text, int width,
@@ -175,9 +199,10 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
                 auto color = this->color_.getColor(*app->themes);
                 app->themes->normalizeColor(color);
 
-                auto e = (new TextLayoutElement(
-                              *this, text, QSize(width, metrics.height()),
-                              color, this->style_, container.getScale()))
+                auto e = container
+                             .createElement<TextLayoutElement>(
+                                 *this, text, QSize(width, metrics.height()),
+                                 color, this->style_, container.getScale())
                              ->setLink(this->getLink());
                 e->setTrailingSpace(trailingSpace);
                 e->setText(text);
@@ -191,10 +216,11 @@ void TextElement::addToContainer(MessageLayoutContainer &container,
                 return e;
             };
 
-            // fourtf: add again
-            //            if (word.width == -1) {
-            word.width = metrics.width(word.text);
-            //            }
+            if (word.width == -1)
+            {
+                word.width = app->fonts->getWordWidth(
+                    this->style_, container.getScale(), word.text);
+            }
 
             // see if the text fits in the current line
             if (container.fitsInLine(word.width))
@@ -315,15 +341,18 @@ void TwitchModerationElement::addToContainer(MessageLayoutContainer &container,
             if (auto image = action.getImage())
             {
                 container.addElement(
-                    (new ImageLayoutElement(*this, image.get(), size))
+                    container
+                        .createElement<ImageLayoutElement>(*this, image.get(),
+                                                           size)
                         ->setLink(Link(Link::UserAction, action.getAction())));
             }
             else
             {
                 container.addElement(
-                    (new TextIconLayoutElement(*this, action.getLine1(),
-                                               action.getLine2(),
-                                               container.getScale(), size))
+                    container
+                        .createElement<TextIconLayoutElement>(
+                            *this, action.getLine1(), action.getLine2(),
+                            container.getScale(), size)
                         ->setLink(Link(Link::UserAction, action.getAction())));
             }
         }
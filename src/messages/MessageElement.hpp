@@ -182,6 +182,10 @@ private:
         int width = -1;
     };
     std::vector<Word> words_;
+
+    // the word widths are valid for this scale and font generation
+    float wordWidthsScale_ = -1;
+    int wordWidthsGeneration_ = -1;
 };
 
 // contains emote data and will pick the emote based on :
@@ -0,0 +1,196 @@
+#include "messages/layouts/MessageBufferAtlas.hpp"
+
+#include "util/DebugCount.hpp"
+
+#include <algorithm>
+
+namespace chatterino {
+namespace {
+    int64_t memoryUsage(int width, int height, qreal devicePixelRatio)
+    {
+        return int64_t(width * devicePixelRatio) *
+               int64_t(height * devicePixelRatio) * 4;
+    }
+}  // namespace
+
+MessageBufferAtlas::~MessageBufferAtlas()
+{
+    this->clear();
+}
+
+void MessageBufferAtlas::beginFrame(int width, int viewHeight,
+                                    qreal devicePixelRatio)
+{
+    this->frame_++;
+
+    int height = std::max(256, viewHeight * 2);
+
+    // shrink if the view got a lot smaller, bands of tall messages can make
+    // the pixmap grow past the usual size
+    if (width != this->width_ ||
+        devicePixelRatio != this->devicePixelRatio_ ||
+        height > this->height_ || height * 2 < this->height_)
+    {
+        this->resize(width, height, devicePixelRatio);
+    }
+}
+
+MessageBufferAtlas::RegionPtr MessageBufferAtlas::allocate(int height)
+{
+    if (this->width_ <= 0)
+    {
+        return nullptr;
+    }
+
+    height = std::max(1, height);
+
+    if (height > this->height_)
+    {
+        this->resize(this->width_, height * 2, this->devicePixelRatio_);
+    }
+
+    // skip over the bands that are in use this frame. If we went around
+    // without finding space, more than the whole pixmap is on screen.
+    size_t tries = 0;
+
+    while (true)
+    {
+        if (this->cursor_ + height > this->height_)
+        {
+            this->cursor_ = 0;
+        }
+
+        auto blocking = this->findBlockingRegion(this->cursor_, height);
+
+        if (blocking == nullptr)
+        {
+            break;
+        }
+
+        this->cursor_ = blocking->y + blocking->height;
+
+        if (++tries > this->regions_.size() + 1)
+        {
+            this->resize(this->width_, this->height_ * 2,
+                         this->devicePixelRatio_);
+            tries = 0;
+        }
+    }
+
+    // take the space from the bands that are in the way
+    int top = this->cursor_;
+    int bottom = this->cursor_ + height;
+
+    this->regions_.erase(
+        std::remove_if(this->regions_.begin(), this->regions_.end(),
+                       [&](const RegionPtr &region) {
+                           if (region->y < bottom &&
+                               region->y + region->height > top)
+                           {
+                               region->valid = false;
+                               return true;
+                           }
+                           return false;
+                       }),
+        this->regions_.end());
+
+    auto region = std::make_shared<Region>();
+    region->y = top;
+    region->height = height;
+    region->frame = this->frame_;
+
+    this->regions_.push_back(region);
+    this->cursor_ = bottom;
+
+    return region;
+}
+
+void MessageBufferAtlas::use(Region &region)
+{
+    region.frame = this->frame_;
+}
+
+const MessageBufferAtlas::Region *MessageBufferAtlas::findBlockingRegion(
+    int y, int height)
+{
+    const Region *blocking = nullptr;
+
+    // bands that nobody holds on to anymore are free
+    this->regions_.erase(
+        std::remove_if(this->regions_.begin(), this->regions_.end(),
+                       [](const RegionPtr &region) {
+                           return region.use_count() == 1;
+                       }),
+        this->regions_.end());
+
+    for (const auto &region : this->regions_)
+    {
+        if (region->frame == this->frame_ && region->y < y + height &&
+            region->y + region->height > y)
+        {
+            if (blocking == nullptr || region->y + region->height >
+                                           blocking->y + blocking->height)
+                blocking = region.get();
+        }
+    }
+
+    return blocking;
+}
+
+QPixmap &MessageBufferAtlas::getPixmap()
+{
+    return this->pixmap_;
+}
+
+QRectF MessageBufferAtlas::getSourceRect(const Region &region) const
+{
+    // source rects are in device pixels
+    return QRectF(0, region.y * this->devicePixelRatio_,
+                  this->width_ * this->devicePixelRatio_,
+                  region.height * this->devicePixelRatio_);
+}
+
+int MessageBufferAtlas::getWidth() const
+{
+    return this->width_;
+}
+
+void MessageBufferAtlas::clear()
+{
+    this->resize(0, 0, this->devicePixelRatio_);
+}
+
+void MessageBufferAtlas::resize(int width, int height, qreal devicePixelRatio)
+{
+    for (auto &region : this->regions_)
+    {
+        region->valid = false;
+    }
+    this->regions_.clear();
+    this->cursor_ = 0;
+
+    DebugCount::decrease(
+        "message buffer memory (KB)",
+        memoryUsage(this->width_, this->height_, this->devicePixelRatio_) /
+            1024);
+
+    this->width_ = std::max(0, width);
+    this->height_ = std::max(0, height);
+    this->devicePixelRatio_ = devicePixelRatio;
+
+    if (this->width_ == 0 || this->height_ == 0)
+    {
+        this->pixmap_ = QPixmap();
+        return;
+    }
+
+    this->pixmap_ = QPixmap(int(this->width_ * devicePixelRatio),
+                            int(this->height_ * devicePixelRatio));
+    this->pixmap_.setDevicePixelRatio(devicePixelRatio);
+
+    DebugCount::increase(
+        "message buffer memory (KB)",
+        memoryUsage(this->width_, this->height_, devicePixelRatio) / 1024);
+}
+
+}  // namespace chatterino
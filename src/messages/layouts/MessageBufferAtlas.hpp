@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QPixmap>
+#include <QRectF>
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace chatterino {
+
+// The message buffers of a ChannelView are horizontal bands of one pixmap.
+//
+// Bands are handed out like a ring buffer. Bands of messages that scrolled out
+// of view stay valid until the ring comes around to them again, so scrolling
+// back and forth neither allocates nor repaints messages. The pixmap is about
+// twice the height of the view, so the memory depends on the size of the view
+// instead of the number of messages.
+class MessageBufferAtlas : boost::noncopyable
+{
+public:
+    struct Region {
+        int y = 0;
+        int height = 0;
+        int frame = 0;
+
+        // false once the band was given to another message
+        bool valid = true;
+    };
+    using RegionPtr = std::shared_ptr<Region>;
+
+    ~MessageBufferAtlas();
+
+    // Bands that are used during a frame are not given away in the same frame.
+    // Recreates the pixmap if the size of the view changed.
+    void beginFrame(int width, int viewHeight, qreal devicePixelRatio);
+
+    // returns a band of the given height for the current frame, or nullptr
+    // if the view has no width
+    RegionPtr allocate(int height);
+    void use(Region &region);
+
+    QPixmap &getPixmap();
+    QRectF getSourceRect(const Region &region) const;
+    int getWidth() const;
+
+    // frees the pixmap, e.g. when the view is hidden
+    void clear();
+
+private:
+    void resize(int width, int height, qreal devicePixelRatio);
+    const Region *findBlockingRegion(int y, int height);
+
+    QPixmap pixmap_;
+    int width_ = 0;
+    int height_ = 0;
+    qreal devicePixelRatio_ = 1;
+
+    int frame_ = 0;
+    int cursor_ = 0;
+    std::vector<RegionPtr> regions_;
+};
+
+}  // namespace chatterino
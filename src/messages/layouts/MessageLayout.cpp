@@ -48,6 +48,14 @@ int MessageLayout::getHeight() const
     return container_->getHeight();
 }
 
+int MessageLayout::getEstimatedHeight(int fallback) const
+{
+    if (this->currentLayoutWidth_ == -1)
+        return fallback;
+
+    return this->getHeight();
+}
+
 // Layout
 // return true if redraw is required
 bool MessageLayout::layout(int width, float scale, MessageElementFlags flags)
@@ -134,49 +142,48 @@ void MessageLayout::actuallyLayout(int width, MessageElementFlags _flags)
 }
 
 // Painting
-void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
+void MessageLayout::paint(QPainter &painter, MessageBufferAtlas &atlas,
+                          int width, int y, int messageIndex,
                           Selection &selection, bool isLastReadMessage,
                           bool isWindowFocused)
 {
     auto app = getApp();
-    QPixmap *pixmap = this->buffer_.get();
+    int height = this->container_->getHeight();
 
-    // create new buffer if required
-    if (!pixmap)
+    // get a new band if we don't have one or it was given to another message
+    if (!this->buffer_ || !this->buffer_->valid ||
+        this->buffer_->height != std::max(1, height))
     {
-#ifdef Q_OS_MACOS
-        pixmap = new QPixmap(int(width * painter.device()->devicePixelRatioF()),
-                             int(container_->getHeight() *
-                                 painter.device()->devicePixelRatioF()));
-        pixmap->setDevicePixelRatio(painter.device()->devicePixelRatioF());
-#else
-        pixmap =
-            new QPixmap(width, std::max(16, this->container_->getHeight()));
-#endif
-
-        this->buffer_ = std::shared_ptr<QPixmap>(pixmap);
+        this->buffer_ = atlas.allocate(height);
         this->bufferValid_ = false;
-        DebugCount::increase("message drawing buffers");
+
+        if (!this->buffer_)
+        {
+            return;
+        }
     }
 
+    atlas.use(*this->buffer_);
+
     if (!this->bufferValid_ || !selection.isEmpty())
     {
-        this->updateBuffer(pixmap, messageIndex, selection);
+        this->updateBuffer(atlas, messageIndex, selection);
     }
 
     // draw on buffer
-    painter.drawPixmap(0, y, *pixmap);
-    //    painter.drawPixmap(0, y, this->container.width,
-    //    this->container.getHeight(), *pixmap);
+    painter.drawPixmap(QRectF(0, y, atlas.getWidth(), this->buffer_->height),
+                       atlas.getPixmap(), atlas.getSourceRect(*this->buffer_));
 
     // draw gif emotes
-    this->container_->paintAnimatedElements(painter, y);
+    if (this->container_->paintAnimatedElements(painter, y))
+        this->flags.set(MessageLayoutFlag::Animated);
+    else
+        this->flags.unset(MessageLayoutFlag::Animated);
 
     // draw disabled
     if (this->message_->flags.has(MessageFlag::Disabled))
     {
-        painter.fillRect(0, y, pixmap->width(), pixmap->height(),
-                         app->themes->messages.disabled);
+        painter.fillRect(0, y, width, height, app->themes->messages.disabled);
     }
 
     // draw selection
@@ -211,21 +218,26 @@ void MessageLayout::paint(QPainter &painter, int width, int y, int messageIndex,
         QBrush brush(color, static_cast<Qt::BrushStyle>(
                                 getSettings()->lastMessagePattern.getValue()));
 
-        painter.fillRect(0, y + this->container_->getHeight() - 1,
-                         pixmap->width(), 1, brush);
+        painter.fillRect(0, y + height - 1, width, 1, brush);
     }
 
     this->bufferValid_ = true;
 }
 
-void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
+void MessageLayout::updateBuffer(MessageBufferAtlas &atlas,
+                                 int /*messageIndex*/,
                                  Selection & /*selection*/)
 {
     auto app = getApp();
 
-    QPainter painter(buffer);
+    QPainter painter(&atlas.getPixmap());
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
 
+    // only draw into our own band
+    auto rect = QRect(0, 0, atlas.getWidth(), this->buffer_->height);
+    painter.translate(0, this->buffer_->y);
+    painter.setClipRect(rect);
+
     // draw background
     QColor backgroundColor = app->themes->messages.backgrounds.regular;
     if (this->message_->flags.has(MessageFlag::Highlighted) &&
@@ -243,7 +255,7 @@ void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
         backgroundColor = app->themes->messages.backgrounds.alternate;
     }
 
-    painter.fillRect(buffer->rect(), backgroundColor);
+    painter.fillRect(rect, backgroundColor);
 
     // draw message
     this->container_->paintElements(painter);
@@ -251,8 +263,7 @@ void MessageLayout::updateBuffer(QPixmap *buffer, int /*messageIndex*/,
 #ifdef FOURTF
     // debug
     painter.setPen(QColor(255, 0, 0));
-    painter.drawRect(buffer->rect().x(), buffer->rect().y(),
-                     buffer->rect().width() - 1, buffer->rect().height() - 1);
+    painter.drawRect(rect.x(), rect.y(), rect.width() - 1, rect.height() - 1);
 
     QTextOption option;
     option.setAlignment(Qt::AlignRight | Qt::AlignTop);
@@ -269,12 +280,7 @@ void MessageLayout::invalidateBuffer()
 
 void MessageLayout::deleteBuffer()
 {
-    if (this->buffer_ != nullptr)
-    {
-        DebugCount::decrease("message drawing buffers");
-
-        this->buffer_ = nullptr;
-    }
+    this->buffer_ = nullptr;
 }
 
 void MessageLayout::deleteCache()
@@ -313,6 +319,12 @@ int MessageLayout::getSelectionIndex(QPoint position)
     return this->container_->getSelectionIndex(position);
 }
 
+void MessageLayout::forEachImage(
+    const std::function<void(const Image *)> &func) const
+{
+    this->container_->forEachImage(func);
+}
+
 void MessageLayout::addSelectionText(QString &str, int from, int to,
                                      CopyMode copymode)
 {
@@ -2,10 +2,12 @@
 
 #include "common/Common.hpp"
 #include "common/FlagsEnum.hpp"
+#include "messages/layouts/MessageBufferAtlas.hpp"
 
 #include <QPixmap>
 #include <boost/noncopyable.hpp>
 #include <cinttypes>
+#include <functional>
 #include <memory>
 
 namespace chatterino {
@@ -16,6 +18,7 @@ using MessagePtr = std::shared_ptr<const Message>;
 struct Selection;
 struct MessageLayoutContainer;
 class MessageLayoutElement;
+class Image;
 
 enum class MessageElementFlag;
 using MessageElementFlags = FlagsEnum<MessageElementFlag>;
@@ -27,6 +30,8 @@ enum class MessageLayoutFlag : uint8_t {
     Collapsed = 1 << 4,
     Expanded = 1 << 5,
     IgnoreHighlights = 1 << 6,
+    // set when the last paint drew an animated image
+    Animated = 1 << 7,
 };
 using MessageLayoutFlags = FlagsEnum<MessageLayoutFlag>;
 
@@ -39,14 +44,17 @@ public:
     const Message *getMessage();
 
     int getHeight() const;
+    // height of the last layout, even if it was done for another width.
+    // Returns the fallback if the message was never laid out.
+    int getEstimatedHeight(int fallback) const;
 
     MessageLayoutFlags flags;
 
     bool layout(int width, float scale_, MessageElementFlags flags);
 
     // Painting
-    void paint(QPainter &painter, int width, int y, int messageIndex,
-               Selection &selection, bool isLastReadMessage,
+    void paint(QPainter &painter, MessageBufferAtlas &atlas, int width, int y,
+               int messageIndex, Selection &selection, bool isLastReadMessage,
                bool isWindowFocused);
     void invalidateBuffer();
     void deleteBuffer();
@@ -57,6 +65,7 @@ public:
     int getLastCharacterIndex() const;
     int getFirstMessageCharacterIndex() const;
     int getSelectionIndex(QPoint position);
+    void forEachImage(const std::function<void(const Image *)> &func) const;
     void addSelectionText(QString &str, int from = 0, int to = INT_MAX,
                           CopyMode copymode = CopyMode::Everything);
 
@@ -67,7 +76,8 @@ private:
     // variables
     MessagePtr message_;
     std::shared_ptr<MessageLayoutContainer> container_;
-    std::shared_ptr<QPixmap> buffer_{};
+    // band of the atlas of the ChannelView showing the message
+    std::shared_ptr<MessageBufferAtlas::Region> buffer_{};
     bool bufferValid_ = false;
 
     int height_ = 0;
@@ -83,7 +93,8 @@ private:
 
     // methods
     void actuallyLayout(int width, MessageElementFlags flags);
-    void updateBuffer(QPixmap *pixmap, int messageIndex, Selection &selection);
+    void updateBuffer(MessageBufferAtlas &atlas, int messageIndex,
+                      Selection &selection);
 };
 
 using MessageLayoutPtr = std::shared_ptr<MessageLayout>;
@@ -12,11 +12,22 @@
 #include <QDebug>
 #include <QPainter>
 
+#include <algorithm>
+
 #define COMPACT_EMOTES_OFFSET 6
 #define MAX_UNCOLLAPSED_LINES \
     (getSettings()->collpseMessagesMinLines.getValue())
 
 namespace chatterino {
+namespace {
+    // enough for a few short words, every further block is twice as big
+    const size_t firstBlockSize = 1024;
+}  // namespace
+
+MessageLayoutContainer::~MessageLayoutContainer()
+{
+    this->destroyElements();
+}
 
 int MessageLayoutContainer::getHeight() const
 {
@@ -51,7 +62,7 @@ void MessageLayoutContainer::begin(int width, float scale, MessageFlags flags)
 
 void MessageLayoutContainer::clear()
 {
-    this->elements_.clear();
+    this->destroyElements();
     this->lines_.clear();
 
     this->height_ = 0;
@@ -79,6 +90,45 @@ void MessageLayoutContainer::addElementNoLineBreak(
     this->_addElement(element);
 }
 
+void *MessageLayoutContainer::allocateElement(size_t size, size_t alignment)
+{
+    while (this->blockIndex_ < this->blocks_.size())
+    {
+        auto &block = this->blocks_[this->blockIndex_];
+
+        auto offset =
+            (this->blockOffset_ + alignment - 1) / alignment * alignment;
+
+        if (offset + size <= block.size)
+        {
+            this->blockOffset_ = offset + size;
+            return block.data.get() + offset;
+        }
+
+        this->blockIndex_++;
+        this->blockOffset_ = 0;
+    }
+
+    auto blockSize = std::max(size, firstBlockSize << this->blocks_.size());
+    this->blocks_.push_back(
+        Block{std::unique_ptr<char[]>(new char[blockSize]), blockSize});
+
+    this->blockOffset_ = size;
+    return this->blocks_.back().data.get();
+}
+
+void MessageLayoutContainer::destroyElements()
+{
+    for (auto element : this->elements_)
+    {
+        element->~MessageLayoutElement();
+    }
+
+    this->elements_.clear();
+    this->blockIndex_ = 0;
+    this->blockOffset_ = 0;
+}
+
 bool MessageLayoutContainer::canAddElements()
 {
     return this->canAddMessages_;
@@ -89,7 +139,8 @@ void MessageLayoutContainer::_addElement(MessageLayoutElement *element,
 {
     if (!this->canAddElements() && !forceAdd)
     {
-        delete element;
+        // the memory is reused once the container is cleared
+        element->~MessageLayoutElement();
         return;
     }
 
@@ -120,7 +171,7 @@ void MessageLayoutContainer::_addElement(MessageLayoutElement *element,
         QPoint(this->currentX_, this->currentY_ - element->getRect().height()));
 
     // add element
-    this->elements_.push_back(std::unique_ptr<MessageLayoutElement>(element));
+    this->elements_.push_back(element);
 
     // set current x
     this->currentX_ += element->getRect().width();
@@ -146,7 +197,7 @@ void MessageLayoutContainer::breakLine()
 
     for (size_t i = lineStart_; i < this->elements_.size(); i++)
     {
-        MessageLayoutElement *element = this->elements_.at(i).get();
+        MessageLayoutElement *element = this->elements_.at(i);
 
         bool isCompactEmote =
             getSettings()->compactEmotes &&
@@ -224,7 +275,7 @@ void MessageLayoutContainer::end()
                                      MessageColor::Link);
         static QString dotdotdotText("...");
 
-        auto *element = new TextLayoutElement(
+        auto *element = this->createElement<TextLayoutElement>(
             dotdotdot, dotdotdotText,
             QSize(this->dotdotdotWidth_, this->textLineHeight_),
             QColor("#00D80A"), FontStyle::ChatMediumBold, this->scale_);
@@ -263,21 +314,31 @@ bool MessageLayoutContainer::isCollapsed()
 
 MessageLayoutElement *MessageLayoutContainer::getElementAt(QPoint point)
 {
-    for (std::unique_ptr<MessageLayoutElement> &element : this->elements_)
+    for (MessageLayoutElement *element : this->elements_)
     {
         if (element->getRect().contains(point))
         {
-            return element.get();
+            return element;
         }
     }
 
     return nullptr;
 }
 
+void MessageLayoutContainer::forEachImage(
+    const std::function<void(const Image *)> &func) const
+{
+    for (MessageLayoutElement *element : this->elements_)
+    {
+        if (auto image = element->getImage())
+            func(image);
+    }
+}
+
 // painting
 void MessageLayoutContainer::paintElements(QPainter &painter)
 {
-    for (const std::unique_ptr<MessageLayoutElement> &element : this->elements_)
+    for (MessageLayoutElement *element : this->elements_)
     {
 #ifdef FOURTF
         painter.setPen(QColor(0, 255, 0));
@@ -288,13 +349,17 @@ void MessageLayoutContainer::paintElements(QPainter &painter)
     }
 }
 
-void MessageLayoutContainer::paintAnimatedElements(QPainter &painter,
+bool MessageLayoutContainer::paintAnimatedElements(QPainter &painter,
                                                    int yOffset)
 {
-    for (const std::unique_ptr<MessageLayoutElement> &element : this->elements_)
+    bool animated = false;
+
+    for (MessageLayoutElement *element : this->elements_)
     {
-        element->paintAnimated(painter, yOffset);
+        animated |= element->paintAnimated(painter, yOffset);
     }
+
+    return animated;
 }
 
 void MessageLayoutContainer::paintSelection(QPainter &painter, int messageIndex,
@@ -2,7 +2,11 @@
 
 #include <QPoint>
 #include <QRect>
+#include <functional>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "common/Common.hpp"
@@ -44,6 +48,10 @@ struct Margin {
 
 struct MessageLayoutContainer {
     MessageLayoutContainer() = default;
+    ~MessageLayoutContainer();
+
+    MessageLayoutContainer(const MessageLayoutContainer &) = delete;
+    MessageLayoutContainer &operator=(const MessageLayoutContainer &) = delete;
 
     Margin margin = {4, 8, 4, 8};
     bool centered = false;
@@ -59,16 +67,31 @@ struct MessageLayoutContainer {
 
     void clear();
     bool canAddElements();
+
+    // Creates an element in memory owned by the container. The memory is
+    // reused by the next layout instead of allocating every element again.
+    // Elements created this way have to be passed to addElement or
+    // addElementNoLineBreak.
+    template <typename T, typename... Args>
+    T *createElement(Args &&... args)
+    {
+        static_assert(std::is_base_of<MessageLayoutElement, T>::value,
+                      "T must be a MessageLayoutElement");
+
+        return new (this->allocateElement(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+    }
     void addElement(MessageLayoutElement *element);
     void addElementNoLineBreak(MessageLayoutElement *element);
     void breakLine();
     bool atStartOfLine();
     bool fitsInLine(int width_);
     MessageLayoutElement *getElementAt(QPoint point);
+    void forEachImage(const std::function<void(const Image *)> &func) const;
 
     // painting
     void paintElements(QPainter &painter);
-    void paintAnimatedElements(QPainter &painter, int yOffset);
+    bool paintAnimatedElements(QPainter &painter, int yOffset);
     void paintSelection(QPainter &painter, int messageIndex,
                         Selection &selection, int yOffset);
 
@@ -89,9 +112,16 @@ private:
         QRect rect;
     };
 
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
     // helpers
     void _addElement(MessageLayoutElement *element, bool forceAdd = false);
     bool canCollapse();
+    void *allocateElement(size_t size, size_t alignment);
+    void destroyElements();
 
     // variables
     float scale_ = 1.f;
@@ -110,8 +140,13 @@ private:
     bool canAddMessages_ = true;
     bool isCollapsed_ = false;
 
-    std::vector<std::unique_ptr<MessageLayoutElement>> elements_;
+    std::vector<MessageLayoutElement *> elements_;
     std::vector<Line> lines_;
+
+    // the elements live in these blocks, which are kept between layouts
+    std::vector<Block> blocks_;
+    size_t blockIndex_ = 0;
+    size_t blockOffset_ = 0;
 };
 
 }  // namespace chatterino
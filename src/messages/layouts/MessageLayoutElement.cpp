@@ -79,6 +79,11 @@ FlagsEnum<MessageElementFlag> MessageLayoutElement::getFlags() const
     return this->creator_.getFlags();
 }
 
+const Image *MessageLayoutElement::getImage() const
+{
+    return nullptr;
+}
+
 //
 // IMAGE
 //
@@ -126,11 +131,11 @@ void ImageLayoutElement::paint(QPainter &painter)
     }
 }
 
-void ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
+bool ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
 {
     if (this->image_ == nullptr)
     {
-        return;
+        return false;
     }
 
     if (this->image_->animated())
@@ -140,8 +145,11 @@ void ImageLayoutElement::paintAnimated(QPainter &painter, int yOffset)
             auto rect = this->getRect();
             rect.moveTop(rect.y() + yOffset);
             painter.drawPixmap(QRectF(rect), *pixmap, QRectF());
+            return true;
         }
     }
+
+    return false;
 }
 
 int ImageLayoutElement::getMouseOverIndex(const QPoint &abs) const
@@ -166,6 +174,11 @@ int ImageLayoutElement::getXFromIndex(int index)
     }
 }
 
+const Image *ImageLayoutElement::getImage() const
+{
+    return this->image_.get();
+}
+
 //
 // TEXT
 //
@@ -221,8 +234,9 @@ void TextLayoutElement::paint(QPainter &painter)
         this->getText(), QTextOption(Qt::AlignLeft | Qt::AlignTop));
 }
 
-void TextLayoutElement::paintAnimated(QPainter &, int)
+bool TextLayoutElement::paintAnimated(QPainter &, int)
 {
+    return false;
 }
 
 int TextLayoutElement::getMouseOverIndex(const QPoint &abs) const
@@ -336,8 +350,9 @@ void TextIconLayoutElement::paint(QPainter &painter)
     }
 }
 
-void TextIconLayoutElement::paintAnimated(QPainter &painter, int yOffset)
+bool TextIconLayoutElement::paintAnimated(QPainter &painter, int yOffset)
 {
+    return false;
 }
 
 int TextIconLayoutElement::getMouseOverIndex(const QPoint &abs) const
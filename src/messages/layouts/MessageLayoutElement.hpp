@@ -38,9 +38,12 @@ public:
                                      int to = INT_MAX) const = 0;
     virtual int getSelectionIndexCount() const = 0;
     virtual void paint(QPainter &painter) = 0;
-    virtual void paintAnimated(QPainter &painter, int yOffset) = 0;
+    // returns true if an animated image was painted
+    virtual bool paintAnimated(QPainter &painter, int yOffset) = 0;
     virtual int getMouseOverIndex(const QPoint &abs) const = 0;
     virtual int getXFromIndex(int index) = 0;
+    // returns the image this element shows, if any
+    virtual const Image *getImage() const;
     const Link &getLink() const;
     const QString &getText() const;
     FlagsEnum<MessageElementFlag> getFlags() const;
@@ -67,9 +70,10 @@ protected:
                              int to = INT_MAX) const override;
     int getSelectionIndexCount() const override;
     void paint(QPainter &painter) override;
-    void paintAnimated(QPainter &painter, int yOffset) override;
+    bool paintAnimated(QPainter &painter, int yOffset) override;
     int getMouseOverIndex(const QPoint &abs) const override;
     int getXFromIndex(int index) override;
+    const Image *getImage() const override;
 
 private:
     ImagePtr image_;
@@ -90,7 +94,7 @@ protected:
                              int to = INT_MAX) const override;
     int getSelectionIndexCount() const override;
     void paint(QPainter &painter) override;
-    void paintAnimated(QPainter &painter, int yOffset) override;
+    bool paintAnimated(QPainter &painter, int yOffset) override;
     int getMouseOverIndex(const QPoint &abs) const override;
     int getXFromIndex(int index) override;
 
@@ -115,7 +119,7 @@ protected:
                              int to = INT_MAX) const override;
     int getSelectionIndexCount() const override;
     void paint(QPainter &painter) override;
-    void paintAnimated(QPainter &painter, int yOffset) override;
+    bool paintAnimated(QPainter &painter, int yOffset) override;
     int getMouseOverIndex(const QPoint &abs) const override;
     int getXFromIndex(int index) override;
 
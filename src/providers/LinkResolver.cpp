@@ -20,6 +20,8 @@ void LinkResolver::getLinkInfo(
     NetworkRequest request(requestUrl);
     request.setCaller(QThread::currentThread());
     request.setTimeout(30000);
+    // tooltips can wait for everything else
+    request.setPriority(NetworkRequestPriority::Low);
     request.onSuccess([successCallback, url](auto result) mutable -> Outcome {
         auto root = result.parseJson();
         auto statusCode = root.value("status").toInt();
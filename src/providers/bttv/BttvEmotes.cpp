@@ -7,8 +7,8 @@
 #include "messages/Image.hpp"
 #include "messages/ImageSet.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
+#include "util/JsonSaxHandler.hpp"
 
-#include <QJsonArray>
 #include <QThread>
 
 namespace chatterino {
@@ -21,19 +21,63 @@ namespace {
         return {urlTemplate.replace("{{id}}", id.string)
                     .replace("{{image}}", emoteScale)};
     }
+    // reads the emote list without building a document, the url template
+    // might come after the emotes so they are only collected here
+    class EmoteListHandler : public JsonSaxHandler<EmoteListHandler>
+    {
+    public:
+        bool value(const char *str, size_t length)
+        {
+            if (this->isAt({"urlTemplate"}))
+            {
+                this->urlTemplate =
+                    qS("https:") + QString::fromUtf8(str, int(length));
+            }
+            else if (this->isAt({"emotes", "", "id"}))
+            {
+                this->current_.first =
+                    EmoteId{QString::fromUtf8(str, int(length))};
+            }
+            else if (this->isAt({"emotes", "", "code"}))
+            {
+                this->current_.second =
+                    EmoteName{QString::fromUtf8(str, int(length))};
+            }
+
+            return true;
+        }
+
+        bool objectEnded()
+        {
+            if (this->isAt({"emotes", ""}))
+            {
+                this->emotes.push_back(std::move(this->current_));
+                this->current_ = {};
+            }
+
+            return true;
+        }
+
+        QString urlTemplate;
+        std::vector<std::pair<EmoteId, EmoteName>> emotes;
+
+    private:
+        std::pair<EmoteId, EmoteName> current_;
+    };
     std::pair<Outcome, EmoteMap> parseGlobalEmotes(
-        const QJsonObject &jsonRoot, const EmoteMap &currentEmotes)
+        const NetworkResult &result, const EmoteMap &currentEmotes)
     {
+        EmoteListHandler handler;
+        if (!result.parseJsonSax(handler))
+            return {Failure, EmoteMap()};
+
         auto emotes = EmoteMap();
-        auto jsonEmotes = jsonRoot.value("emotes").toArray();
-        auto urlTemplate =
-            qS("https:") + jsonRoot.value("urlTemplate").toString();
+        auto &urlTemplate = handler.urlTemplate;
 
-        for (auto jsonEmote : jsonEmotes)
+        for (auto &item : handler.emotes)
         {
-            auto id = EmoteId{jsonEmote.toObject().value("id").toString()};
-            auto name =
-                EmoteName{jsonEmote.toObject().value("code").toString()};
+            auto &id = item.first;
+            auto &name = item.second;
 
             auto emote = Emote(
                 {name,
@@ -57,19 +101,19 @@ namespace {
 
         return cachedOrMakeEmotePtr(std::move(emote), cache, mutex, id);
     }
-    std::pair<Outcome, EmoteMap> parseChannelEmotes(const QJsonObject &jsonRoot)
+    std::pair<Outcome, EmoteMap> parseChannelEmotes(const NetworkResult &result)
     {
+        EmoteListHandler handler;
+        if (!result.parseJsonSax(handler))
+            return {Failure, EmoteMap()};
+
         auto emotes = EmoteMap();
-        auto jsonEmotes = jsonRoot.value("emotes").toArray();
-        auto urlTemplate = "https:" + jsonRoot.value("urlTemplate").toString();
+        auto &urlTemplate = handler.urlTemplate;
 
-        for (auto jsonEmote_ : jsonEmotes)
+        for (auto &item : handler.emotes)
         {
-            auto jsonEmote = jsonEmote_.toObject();
-
-            auto id = EmoteId{jsonEmote.value("id").toString()};
-            auto name = EmoteName{jsonEmote.value("code").toString()};
-            // emoteObject.value("imageType").toString();
+            auto &id = item.first;
+            auto &name = item.second;
 
             auto emote = Emote(
                 {name,
@@ -119,7 +163,7 @@ void BttvEmotes::loadEmotes()
 
     request.onSuccess([this](auto result) -> Outcome {
         auto emotes = this->global_.get();
-        auto pair = parseGlobalEmotes(result.parseJson(), *emotes);
+        auto pair = parseGlobalEmotes(result, *emotes);
         if (pair.first)
             this->global_.set(
                 std::make_shared<EmoteMap>(std::move(pair.second)));
@@ -139,7 +183,7 @@ void BttvEmotes::loadChannel(const QString &channelName,
     request.setTimeout(3000);
 
     request.onSuccess([callback = std::move(callback)](auto result) -> Outcome {
-        auto pair = parseChannelEmotes(result.parseJson());
+        auto pair = parseChannelEmotes(result);
         if (pair.first)
             callback(std::move(pair.second));
         return pair.first;
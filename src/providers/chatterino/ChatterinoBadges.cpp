@@ -24,6 +24,8 @@ ChatterinoBadges::ChatterinoBadges()
 
 boost::optional<EmotePtr> ChatterinoBadges::getBadge(const UserName &username)
 {
+    std::shared_lock<std::shared_mutex> lock(this->mutex_);
+
     auto it = badgeMap.find(username.string);
     if (it != badgeMap.end())
     {
@@ -41,6 +43,9 @@ void ChatterinoBadges::loadChatterinoBadges()
 
     req.onSuccess([this](auto result) -> Outcome {
         auto jsonRoot = result.parseJson();
+
+        std::unique_lock<std::shared_mutex> lock(this->mutex_);
+
         int index = 0;
         for (const auto &jsonBadge_ : jsonRoot.value("badges").toArray())
         {
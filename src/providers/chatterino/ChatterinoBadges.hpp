@@ -6,6 +6,7 @@
 #include "common/Aliases.hpp"
 
 #include <map>
+#include <shared_mutex>
 #include <vector>
 
 namespace chatterino {
@@ -23,6 +24,9 @@ public:
 
 private:
     void loadChatterinoBadges();
+
+    // badges are looked up from the message builder threads
+    std::shared_mutex mutex_;
     std::map<QString, int> badgeMap;
     std::vector<EmotePtr> emotes;
 };
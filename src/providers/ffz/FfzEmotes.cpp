@@ -1,36 +1,85 @@
 #include "providers/ffz/FfzEmotes.hpp"
 
-#include <QJsonArray>
-
 #include "common/NetworkRequest.hpp"
 #include "common/Outcome.hpp"
 #include "debug/Log.hpp"
 #include "messages/Emote.hpp"
 #include "messages/Image.hpp"
+#include "util/JsonSaxHandler.hpp"
 
 namespace chatterino {
 namespace {
-    Url getEmoteLink(const QJsonObject &urls, const QString &emoteScale)
+    // reads the emotes of all sets without building a document
+    class EmoteSetsHandler : public JsonSaxHandler<EmoteSetsHandler>
     {
-        auto emote = urls.value(emoteScale);
-        if (emote.isUndefined())
+    public:
+        struct Entry {
+            EmoteId id;
+            EmoteName name;
+            QString url1x;
+            QString url2x;
+            QString url3x;
+        };
+
+        bool value(const char *str, size_t length)
         {
-            return {""};
+            auto field = [&](const char *key) {
+                return this->isAt({"sets", nullptr, "emoticons", "", key});
+            };
+            auto url = [&](const char *scale) {
+                return this->isAt(
+                    {"sets", nullptr, "emoticons", "", "urls", scale});
+            };
+            auto string = [&] { return QString::fromUtf8(str, int(length)); };
+
+            if (field("id"))
+                this->current_.id = EmoteId{string()};
+            else if (field("name"))
+                this->current_.name = EmoteName{string()};
+            else if (url("1"))
+                this->current_.url1x = string();
+            else if (url("2"))
+                this->current_.url2x = string();
+            else if (url("4"))
+                this->current_.url3x = string();
+
+            return true;
+        }
+
+        bool objectEnded()
+        {
+            if (this->isAt({"sets", nullptr, "emoticons", ""}))
+            {
+                this->emotes.push_back(std::move(this->current_));
+                this->current_ = {};
+            }
+
+            return true;
         }
 
-        assert(emote.isString());
+        std::vector<Entry> emotes;
+
+    private:
+        Entry current_;
+    };
+    Url getEmoteLink(const QString &url)
+    {
+        if (url.isEmpty())
+        {
+            return {""};
+        }
 
-        return {"https:" + emote.toString()};
+        return {"https:" + url};
     }
-    void fillInEmoteData(const QJsonObject &urls, const EmoteName &name,
+    void fillInEmoteData(const EmoteSetsHandler::Entry &entry,
                          const QString &tooltip, Emote &emoteData)
     {
-        auto url1x = getEmoteLink(urls, "1");
-        auto url2x = getEmoteLink(urls, "2");
-        auto url3x = getEmoteLink(urls, "4");
+        auto url1x = getEmoteLink(entry.url1x);
+        auto url2x = getEmoteLink(entry.url2x);
+        auto url3x = getEmoteLink(entry.url3x);
 
         //, code, tooltip
-        emoteData.name = name;
+        emoteData.name = entry.name;
         emoteData.images =
             ImageSet{Image::fromUrl(url1x, 1), Image::fromUrl(url2x, 0.5),
                      Image::fromUrl(url3x, 0.25)};
@@ -44,67 +93,55 @@ namespace {
         return cachedOrMakeEmotePtr(std::move(emote), cache, mutex, id);
     }
     std::pair<Outcome, EmoteMap> parseGlobalEmotes(
-        const QJsonObject &jsonRoot, const EmoteMap &currentEmotes)
+        const NetworkResult &result, const EmoteMap &currentEmotes)
     {
-        auto jsonSets = jsonRoot.value("sets").toObject();
+        EmoteSetsHandler handler;
+        if (!result.parseJsonSax(handler))
+            return {Failure, EmoteMap()};
+
         auto emotes = EmoteMap();
 
-        for (auto jsonSet : jsonSets)
+        for (auto &entry : handler.emotes)
         {
-            auto jsonEmotes = jsonSet.toObject().value("emoticons").toArray();
-
-            for (auto jsonEmoteValue : jsonEmotes)
-            {
-                auto jsonEmote = jsonEmoteValue.toObject();
-
-                auto name = EmoteName{jsonEmote.value("name").toString()};
-                auto id = EmoteId{jsonEmote.value("id").toString()};
-                auto urls = jsonEmote.value("urls").toObject();
-
-                auto emote = Emote();
-                fillInEmoteData(urls, name,
-                                name.string + "<br/>Global FFZ Emote", emote);
-                emote.homePage =
-                    Url{QString("https://www.frankerfacez.com/emoticon/%1-%2")
-                            .arg(id.string)
-                            .arg(name.string)};
-
-                emotes[name] =
-                    cachedOrMakeEmotePtr(std::move(emote), currentEmotes);
-            }
+            auto &name = entry.name;
+            auto &id = entry.id;
+
+            auto emote = Emote();
+            fillInEmoteData(entry, name.string + "<br/>Global FFZ Emote",
+                            emote);
+            emote.homePage =
+                Url{QString("https://www.frankerfacez.com/emoticon/%1-%2")
+                        .arg(id.string)
+                        .arg(name.string)};
+
+            emotes[name] =
+                cachedOrMakeEmotePtr(std::move(emote), currentEmotes);
         }
 
         return {Success, std::move(emotes)};
     }
-    std::pair<Outcome, EmoteMap> parseChannelEmotes(const QJsonObject &jsonRoot)
+    std::pair<Outcome, EmoteMap> parseChannelEmotes(const NetworkResult &result)
     {
-        auto jsonSets = jsonRoot.value("sets").toObject();
+        EmoteSetsHandler handler;
+        if (!result.parseJsonSax(handler))
+            return {Failure, EmoteMap()};
+
         auto emotes = EmoteMap();
 
-        for (auto jsonSet : jsonSets)
+        for (auto &entry : handler.emotes)
         {
-            auto jsonEmotes = jsonSet.toObject().value("emoticons").toArray();
-
-            for (auto _jsonEmote : jsonEmotes)
-            {
-                auto jsonEmote = _jsonEmote.toObject();
-
-                // margins
-                auto id =
-                    EmoteId{QString::number(jsonEmote.value("id").toInt())};
-                auto name = EmoteName{jsonEmote.value("name").toString()};
-                auto urls = jsonEmote.value("urls").toObject();
-
-                Emote emote;
-                fillInEmoteData(urls, name,
-                                name.string + "<br/>Channel FFZ Emote", emote);
-                emote.homePage =
-                    Url{QString("https://www.frankerfacez.com/emoticon/%1-%2")
-                            .arg(id.string)
-                            .arg(name.string)};
-
-                emotes[name] = cachedOrMake(std::move(emote), id);
-            }
+            auto &name = entry.name;
+            auto &id = entry.id;
+
+            Emote emote;
+            fillInEmoteData(entry, name.string + "<br/>Channel FFZ Emote",
+                            emote);
+            emote.homePage =
+                Url{QString("https://www.frankerfacez.com/emoticon/%1-%2")
+                        .arg(id.string)
+                        .arg(name.string)};
+
+            emotes[name] = cachedOrMake(std::move(emote), id);
         }
 
         return {Success, std::move(emotes)};
@@ -140,7 +177,7 @@ void FfzEmotes::loadEmotes()
 
     request.onSuccess([this](auto result) -> Outcome {
         auto emotes = this->emotes();
-        auto pair = parseGlobalEmotes(result.parseJson(), *emotes);
+        auto pair = parseGlobalEmotes(result, *emotes);
         if (pair.first)
             this->global_.set(
                 std::make_shared<EmoteMap>(std::move(pair.second)));
@@ -161,7 +198,7 @@ void FfzEmotes::loadChannel(const QString &channelName,
     request.setTimeout(20000);
 
     request.onSuccess([callback = std::move(callback)](auto result) -> Outcome {
-        auto pair = parseChannelEmotes(result.parseJson());
+        auto pair = parseChannelEmotes(result);
         if (pair.first)
             callback(std::move(pair.second));
         return pair.first;
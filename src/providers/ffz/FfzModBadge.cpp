@@ -47,7 +47,7 @@ void FfzModBadge::loadCustomModBadge()
                            Tooltip{"Twitch Channel Moderator"},
                            Url{url}};
 
-        this->badge_ = std::make_shared<Emote>(emote);
+        this->badge_.set(std::make_shared<Emote>(emote));
         //        getBadge.execute();
 
         return Success;
@@ -58,7 +58,7 @@ void FfzModBadge::loadCustomModBadge()
 
 EmotePtr FfzModBadge::badge() const
 {
-    return this->badge_;
+    return this->badge_.get();
 }
 
 }  // namespace chatterino
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "common/Atomic.hpp"
+
 #include <QString>
 #include <boost/optional.hpp>
 
@@ -19,7 +21,7 @@ public:
 
 private:
     const QString channelName_;
-    EmotePtr badge_;
+    Atomic<EmotePtr> badge_;
 };
 
 }  // namespace chatterino
@@ -5,6 +5,7 @@
 #include "debug/Log.hpp"
 #include "messages/LimitedQueue.hpp"
 #include "messages/Message.hpp"
+#include "messages/MessageBuildQueue.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "providers/twitch/TwitchHelpers.hpp"
 #include "providers/twitch/TwitchMessageBuilder.hpp"
@@ -62,30 +63,47 @@ void IrcMessageHandler::addMessage(Communi::IrcMessage *_message,
         args.isStaffOrBroadcaster = true;
     }
 
-    TwitchMessageBuilder builder(chan.get(), _message, args, content, isAction);
+    auto builder = std::make_shared<TwitchMessageBuilder>(
+        chan.get(), _message, args, content, isAction);
 
-    if (isSub || !builder.isIgnored())
+    if (isSub)
     {
-        if (isSub)
-        {
-            builder->flags.set(MessageFlag::Subscription);
-            builder->flags.unset(MessageFlag::Highlighted);
-        }
+        (*builder)->flags.set(MessageFlag::Subscription);
+        (*builder)->flags.unset(MessageFlag::Highlighted);
+    }
 
-        auto msg = builder.build();
-        auto highlighted = msg->flags.has(MessageFlag::Highlighted);
+    // the ignore check and building the message happen on a worker thread,
+    // the queue hands the messages back in the order they arrived
+    MessageBuildQueue::getInstance().push(
+        [builder, chan, isSub]() -> MessagePtr {
+            if (!isSub && builder->isIgnored())
+            {
+                return nullptr;
+            }
 
-        if (!isSub)
-        {
-            if (highlighted)
+            return builder->build();
+        },
+        [builder, chan, isSub, &server](MessagePtr msg) {
+            if (!msg)
             {
-                server.mentionsChannel->addMessage(msg);
-                getApp()->highlights->addHighlight(msg);
+                return;
             }
-        }
 
-        chan->addMessage(msg);
-    }
+            auto highlighted = msg->flags.has(MessageFlag::Highlighted);
+
+            if (!isSub)
+            {
+                if (highlighted)
+                {
+                    server.mentionsChannel->addMessage(msg);
+                    getApp()->highlights->addHighlight(msg);
+                }
+
+                builder->triggerHighlights();
+            }
+
+            chan->addMessage(msg);
+        });
 }
 
 void IrcMessageHandler::handleRoomStateMessage(Communi::IrcMessage *message)
@@ -171,12 +189,18 @@ void IrcMessageHandler::handleClearChatMessage(Communi::IrcMessage *message)
         return;
     }
 
+    // messages of this channel that are still being built have to be added
+    // before the clear or timeout is applied to them
+    auto &buildQueue = MessageBuildQueue::getInstance();
+
     // check if the chat has been cleared by a moderator
     if (message->parameters().length() == 1)
     {
-        chan->disableAllMessages();
-        chan->addMessage(
-            makeSystemMessage("Chat has been cleared by a moderator."));
+        buildQueue.runAfterPending([chan] {
+            chan->disableAllMessages();
+            chan->addMessage(
+                makeSystemMessage("Chat has been cleared by a moderator."));
+        });
 
         return;
     }
@@ -199,10 +223,13 @@ void IrcMessageHandler::handleClearChatMessage(Communi::IrcMessage *message)
     auto timeoutMsg = MessageBuilder(timeoutMessage, username,
                                      durationInSeconds, reason, false)
                           .release();
-    chan->addOrReplaceTimeout(timeoutMsg);
 
-    // refresh all
-    app->windows->repaintVisibleChatWidgets(chan.get());
+    buildQueue.runAfterPending([chan, timeoutMsg] {
+        chan->addOrReplaceTimeout(timeoutMsg);
+
+        // refresh all
+        getApp()->windows->repaintVisibleChatWidgets(chan.get());
+    });
 }
 
 void IrcMessageHandler::handleUserStateMessage(Communi::IrcMessage *message)
@@ -249,26 +276,34 @@ void IrcMessageHandler::handleWhisperMessage(Communi::IrcMessage *message)
     if (!builder.isIgnored())
     {
         MessagePtr _message = builder.build();
+        builder.triggerHighlights();
 
         app->twitch.server->lastUserThatWhisperedMe.set(builder.userName);
 
-        if (_message->flags.has(MessageFlag::Highlighted))
-        {
-            app->twitch.server->mentionsChannel->addMessage(_message);
-        }
+        // the inline copies have to come after the chat that is still being
+        // built
+        MessageBuildQueue::getInstance().runAfterPending([_message] {
+            auto app = getApp();
 
-        c->addMessage(_message);
+            if (_message->flags.has(MessageFlag::Highlighted))
+            {
+                app->twitch.server->mentionsChannel->addMessage(_message);
+            }
 
-        auto overrideFlags = boost::optional<MessageFlags>(_message->flags);
-        overrideFlags->set(MessageFlag::DoNotTriggerNotification);
+            app->twitch.server->whispersChannel->addMessage(_message);
 
-        if (getSettings()->inlineWhispers)
-        {
-            app->twitch.server->forEachChannel(
-                [_message, overrideFlags](ChannelPtr channel) {
-                    channel->addMessage(_message, overrideFlags);  //
-                });
-        }
+            auto overrideFlags =
+                boost::optional<MessageFlags>(_message->flags);
+            overrideFlags->set(MessageFlag::DoNotTriggerNotification);
+
+            if (getSettings()->inlineWhispers)
+            {
+                app->twitch.server->forEachChannel(
+                    [_message, overrideFlags](ChannelPtr channel) {
+                        channel->addMessage(_message, overrideFlags);  //
+                    });
+            }
+        });
     }
 }
 
@@ -324,7 +359,9 @@ void IrcMessageHandler::handleUserNoticeMessage(Communi::IrcMessage *message,
 
         if (!chan->isEmpty())
         {
-            chan->addMessage(newMessage);
+            // after the resub text above, which is still being built
+            MessageBuildQueue::getInstance().runAfterPending(
+                [chan, newMessage] { chan->addMessage(newMessage); });
         }
     }
 }
@@ -361,10 +398,12 @@ void IrcMessageHandler::handleNoticeMessage(Communi::IrcNoticeMessage *message)
     {
         // Notice wasn't targeted at a single channel, send to all twitch
         // channels
-        app->twitch.server->forEachChannelAndSpecialChannels(
-            [msg](const auto &c) {
-                c->addMessage(msg);  //
-            });
+        MessageBuildQueue::getInstance().runAfterPending([msg] {
+            getApp()->twitch.server->forEachChannelAndSpecialChannels(
+                [msg](const auto &c) {
+                    c->addMessage(msg);  //
+                });
+        });
 
         return;
     }
@@ -379,7 +418,9 @@ void IrcMessageHandler::handleNoticeMessage(Communi::IrcNoticeMessage *message)
         return;
     }
 
-    channel->addMessage(msg);
+    // notices come after the chat that arrived before them
+    MessageBuildQueue::getInstance().runAfterPending(
+        [channel, msg] { channel->addMessage(msg); });
 }
 
 void IrcMessageHandler::handleWriteConnectionNoticeMessage(
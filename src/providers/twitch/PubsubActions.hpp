@@ -5,6 +5,7 @@
 
 #include <chrono>
 #include <cinttypes>
+#include <memory>
 
 namespace chatterino {
 
@@ -14,6 +15,7 @@ struct ActionUser {
 };
 
 struct PubSubAction {
+    PubSubAction() = default;
     PubSubAction(const rapidjson::Value &data, const QString &_roomID);
     ActionUser source;
 
@@ -105,4 +107,14 @@ struct ModerationStateAction : PubSubAction {
     bool modded;
 };
 
+struct WhisperAction {
+    // true = sent by us
+    // false = received
+    bool sent = false;
+
+    // Parsing should be done in PubSubManager as well,
+    // but for now we just send the raw data
+    std::shared_ptr<const rapidjson::Document> message;
+};
+
 }  // namespace chatterino
@@ -3,11 +3,14 @@
 #include "debug/Log.hpp"
 #include "providers/twitch/PubsubActions.hpp"
 #include "providers/twitch/PubsubHelpers.hpp"
+#include "util/PostToThread.hpp"
 #include "util/RapidjsonHelpers.hpp"
 
 #include <rapidjson/error/en.h>
 
+#include <algorithm>
 #include <exception>
+#include <random>
 #include <thread>
 
 #define TWITCH_PUBSUB_URL "wss://pubsub-edge.twitch.tv"
@@ -22,6 +25,75 @@ static const char *pingPayload = "{\"type\":\"PING\"}";
 
 static std::map<QString, std::string> sentMessages;
 
+// invoke at most this many actions at once so the gui stays responsive
+// during floods
+static const int maxActionsPerInvoke = 500;
+
+// a new connection is opened before the others are full, so listens don't
+// have to wait for it
+static const int targetListensPerClient = 40;
+
+// listens requested within this time are sent together
+static const auto flushDelay = std::chrono::milliseconds(100);
+
+static const auto minReconnectDelay = std::chrono::seconds(1);
+static const auto maxReconnectDelay = std::chrono::minutes(2);
+
+static const auto statsInterval = std::chrono::seconds(60);
+
+namespace {
+
+    class ActionInvoker : public boost::static_visitor<>
+    {
+    public:
+        explicit ActionInvoker(decltype(PubSub::signals_) &signals)
+            : signals_(signals)
+        {
+        }
+
+        void operator()(const ClearChatAction &action) const
+        {
+            this->signals_.moderation.chatCleared.invoke(action);
+        }
+
+        void operator()(const ModeChangedAction &action) const
+        {
+            this->signals_.moderation.modeChanged.invoke(action);
+        }
+
+        void operator()(const ModerationStateAction &action) const
+        {
+            this->signals_.moderation.moderationStateChanged.invoke(action);
+        }
+
+        void operator()(const BanAction &action) const
+        {
+            this->signals_.moderation.userBanned.invoke(action);
+        }
+
+        void operator()(const UnbanAction &action) const
+        {
+            this->signals_.moderation.userUnbanned.invoke(action);
+        }
+
+        void operator()(const WhisperAction &action) const
+        {
+            if (action.sent)
+            {
+                this->signals_.whisper.sent.invoke(*action.message);
+            }
+            else
+            {
+                this->signals_.whisper.received.invoke(*action.message);
+            }
+        }
+
+    private:
+        decltype(PubSub::signals_) &signals_;
+    };
+
+}  // namespace
+
 namespace detail {
 
     PubSubClient::PubSubClient(WebsocketClient &websocketClient,
@@ -47,24 +119,22 @@ namespace detail {
         this->started_ = false;
     }
 
-    bool PubSubClient::listen(rapidjson::Document &message)
+    bool PubSubClient::listen(const std::vector<std::string> &topics,
+                              std::shared_ptr<TwitchAccount> account)
     {
-        int numRequestedListens = message["data"]["topics"].Size();
-
-        if (this->numListens_ + numRequestedListens > MAX_PUBSUB_LISTENS)
+        if (this->getTopicCount() + int(topics.size()) > MAX_PUBSUB_LISTENS)
         {
             // This PubSubClient is already at its peak listens
             return false;
         }
 
-        this->numListens_ += numRequestedListens;
-
-        for (const auto &topic : message["data"]["topics"].GetArray())
+        for (const auto &topic : topics)
         {
-            this->listeners_.emplace_back(
-                Listener{topic.GetString(), false, false, false});
+            this->listeners_.emplace_back(Listener{topic, account});
         }
 
+        auto message = createListenMessage(topics, account);
+
         auto uuid = CreateUUID();
 
         rj::set(message, "nonce", uuid);
@@ -112,6 +182,14 @@ namespace detail {
         this->send(payload.c_str());
     }
 
+    std::vector<Listener> PubSubClient::takeListeners()
+    {
+        std::vector<Listener> listeners;
+        listeners.swap(this->listeners_);
+
+        return listeners;
+    }
+
     void PubSubClient::handlePong()
     {
         assert(this->awaitingPong_);
@@ -134,6 +212,27 @@ namespace detail {
         return false;
     }
 
+    int PubSubClient::getTopicCount() const
+    {
+        return int(this->listeners_.size());
+    }
+
+    void PubSubClient::countMessage()
+    {
+        this->messageCount_++;
+    }
+
+    void PubSubClient::updateMessageRate(std::chrono::seconds interval)
+    {
+        this->messageRate_ = this->messageCount_ * 60.0 / interval.count();
+        this->messageCount_ = 0;
+    }
+
+    double PubSubClient::getMessageRate() const
+    {
+        return this->messageRate_;
+    }
+
     void PubSubClient::ping()
     {
         assert(this->started_);
@@ -201,7 +300,7 @@ PubSub::PubSub()
                                                      const auto &roomID) {
         ClearChatAction action(data, roomID);
 
-        this->signals_.moderation.chatCleared.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["slowoff"] = [this](const auto &data,
@@ -211,7 +310,7 @@ PubSub::PubSub()
         action.mode = ModeChangedAction::Mode::Slow;
         action.state = ModeChangedAction::State::Off;
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["slow"] = [this](const auto &data,
@@ -253,7 +352,7 @@ PubSub::PubSub()
 
         action.duration = QString(durationArg.GetString()).toUInt(&ok, 10);
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["r9kbetaoff"] = [this](const auto &data,
@@ -263,7 +362,7 @@ PubSub::PubSub()
         action.mode = ModeChangedAction::Mode::R9K;
         action.state = ModeChangedAction::State::Off;
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["r9kbeta"] = [this](const auto &data,
@@ -273,7 +372,7 @@ PubSub::PubSub()
         action.mode = ModeChangedAction::Mode::R9K;
         action.state = ModeChangedAction::State::On;
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["subscribersoff"] =
@@ -283,7 +382,7 @@ PubSub::PubSub()
             action.mode = ModeChangedAction::Mode::SubscribersOnly;
             action.state = ModeChangedAction::State::Off;
 
-            this->signals_.moderation.modeChanged.invoke(action);
+            this->queueAction(std::move(action));
         };
 
     this->moderationActionHandlers["subscribers"] = [this](const auto &data,
@@ -293,7 +392,7 @@ PubSub::PubSub()
         action.mode = ModeChangedAction::Mode::SubscribersOnly;
         action.state = ModeChangedAction::State::On;
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["emoteonlyoff"] =
@@ -303,7 +402,7 @@ PubSub::PubSub()
             action.mode = ModeChangedAction::Mode::EmoteOnly;
             action.state = ModeChangedAction::State::Off;
 
-            this->signals_.moderation.modeChanged.invoke(action);
+            this->queueAction(std::move(action));
         };
 
     this->moderationActionHandlers["emoteonly"] = [this](const auto &data,
@@ -313,7 +412,7 @@ PubSub::PubSub()
         action.mode = ModeChangedAction::Mode::EmoteOnly;
         action.state = ModeChangedAction::State::On;
 
-        this->signals_.moderation.modeChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["unmod"] = [this](const auto &data,
@@ -343,7 +442,7 @@ PubSub::PubSub()
 
         action.modded = false;
 
-        this->signals_.moderation.moderationStateChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["mod"] = [this](const auto &data,
@@ -373,7 +472,7 @@ PubSub::PubSub()
 
         action.modded = true;
 
-        this->signals_.moderation.moderationStateChanged.invoke(action);
+        this->queueAction(std::move(action));
     };
 
     this->moderationActionHandlers["timeout"] = [this](const auto &data,
@@ -413,7 +512,7 @@ PubSub::PubSub()
                 }
             }
 
-            this->signals_.moderation.userBanned.invoke(action);
+            this->queueAction(std::move(action));
         }
         catch (const std::runtime_error &ex)
         {
@@ -450,7 +549,7 @@ PubSub::PubSub()
                 }
             }
 
-            this->signals_.moderation.userBanned.invoke(action);
+            this->queueAction(std::move(action));
         }
         catch (const std::runtime_error &ex)
         {
@@ -481,7 +580,7 @@ PubSub::PubSub()
                 return;
             }
 
-            this->signals_.moderation.userUnbanned.invoke(action);
+            this->queueAction(std::move(action));
         }
         catch (const std::runtime_error &ex)
         {
@@ -512,7 +611,7 @@ PubSub::PubSub()
                 return;
             }
 
-            this->signals_.moderation.userUnbanned.invoke(action);
+            this->queueAction(std::move(action));
         }
         catch (const std::runtime_error &ex)
         {
@@ -536,9 +635,13 @@ PubSub::PubSub()
         bind(&PubSub::onConnectionOpen, this, ::_1));
     this->websocketClient.set_close_handler(
         bind(&PubSub::onConnectionClose, this, ::_1));
+    this->websocketClient.set_fail_handler(
+        bind(&PubSub::onConnectionFail, this, ::_1));
 
     // Add an initial client
     this->addClient();
+
+    this->updateStats();
 }
 
 void PubSub::addClient()
@@ -552,6 +655,7 @@ void PubSub::addClient()
         return;
     }
 
+    this->connecting_++;
     this->websocketClient.connect(con);
 }
 
@@ -567,27 +671,28 @@ void PubSub::listenToWhispers(std::shared_ptr<TwitchAccount> account)
 
     std::string userID = account->getUserId().toStdString();
 
-    log("Connection open!");
-    websocketpp::lib::error_code ec;
-
-    std::vector<std::string> topics({"whispers." + userID});
-
-    this->listen(createListenMessage(topics, account));
-
-    if (ec)
-    {
-        log("Unable to send message to websocket server: {}", ec.message());
-        return;
-    }
+    this->listenToTopic("whispers." + userID, account);
 }
 
 void PubSub::unlistenAllModerationActions()
 {
-    for (const auto &p : this->clients)
-    {
-        const auto &client = p.second;
-        client->unlistenPrefix("chat_moderator_actions.");
-    }
+    this->websocketClient.get_io_service().post([this] {
+        const std::string prefix = "chat_moderator_actions.";
+
+        for (const auto &p : this->clients)
+        {
+            const auto &client = p.second;
+            client->unlistenPrefix(prefix);
+        }
+
+        auto &pending = this->pendingTopics_;
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [&](const PendingTopic &pendingTopic) {
+                                         return pendingTopic.topic.find(
+                                                    prefix) == 0;
+                                     }),
+                      pending.end());
+    });
 }
 
 void PubSub::listenToChannelModerationActions(
@@ -601,65 +706,209 @@ void PubSub::listenToChannelModerationActions(
 
     std::string topic(fS("chat_moderator_actions.{}.{}", userID, channelID));
 
-    if (this->isListeningToTopic(topic))
-    {
-        log("We are already listening to topic {}", topic);
-        return;
-    }
+    this->listenToTopic(topic, account);
+}
 
-    log("Listen to topic {}", topic);
+std::vector<PubSub::ClientStats> PubSub::getClientStats() const
+{
+    std::lock_guard<std::mutex> lock(this->statsMutex_);
 
-    this->listenToTopic(topic, account);
+    return this->clientStats_;
 }
 
 void PubSub::listenToTopic(const std::string &topic,
                            std::shared_ptr<TwitchAccount> account)
 {
-    auto message = createListenMessage({topic}, account);
+    this->websocketClient.get_io_service().post([this, topic, account] {
+        if (this->isListeningToTopic(topic))
+        {
+            log("We are already listening to topic {}", topic);
+            return;
+        }
 
-    this->listen(std::move(message));
+        log("Listen to topic {}", topic);
+
+        this->pendingTopics_.push_back({topic, account});
+        this->queueFlush();
+    });
 }
 
-void PubSub::listen(rapidjson::Document &&msg)
+bool PubSub::isListeningToTopic(const std::string &topic)
 {
-    if (this->tryListen(msg))
+    for (const auto &p : this->clients)
+    {
+        const auto &client = p.second;
+        if (client->isListeningToTopic(topic))
+        {
+            return true;
+        }
+    }
+
+    for (const auto &pendingTopic : this->pendingTopics_)
+    {
+        if (pendingTopic.topic == topic)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PubSub::queueFlush()
+{
+    if (this->flushQueued_)
     {
-        log("Successfully listened!");
         return;
     }
 
-    log("Added to the back of the queue");
-    this->requests.emplace_back(
-        std::make_unique<rapidjson::Document>(std::move(msg)));
+    this->flushQueued_ = true;
+
+    runAfter(this->websocketClient.get_io_service(), flushDelay,
+             [this](auto) { this->flushPendingTopics(); });
 }
 
-bool PubSub::tryListen(rapidjson::Document &msg)
+// Assigns the pending topics to the least loaded clients and sends one LISTEN
+// message per client and account.
+void PubSub::flushPendingTopics()
 {
-    log("tryListen with {} clients", this->clients.size());
+    this->flushQueued_ = false;
+
+    this->openConnections();
+
+    struct Load {
+        detail::PubSubClient *client;
+        int topics;
+        double messageRate;
+    };
+
+    std::vector<Load> loads;
     for (const auto &p : this->clients)
     {
         const auto &client = p.second;
-        if (client->listen(msg))
+        loads.push_back({client.get(), client->getTopicCount(),
+                         client->getMessageRate()});
+    }
+
+    using BatchKey = std::pair<detail::PubSubClient *, TwitchAccount *>;
+    std::map<BatchKey, std::vector<PendingTopic>> batches;
+    std::deque<PendingTopic> leftOver;
+
+    for (auto &pendingTopic : this->pendingTopics_)
+    {
+        auto least = std::min_element(
+            loads.begin(), loads.end(), [](const Load &a, const Load &b) {
+                return std::tie(a.topics, a.messageRate) <
+                       std::tie(b.topics, b.messageRate);
+            });
+
+        if (least == loads.end() || least->topics >= MAX_PUBSUB_LISTENS)
         {
-            return true;
+            // wait for another connection
+            leftOver.push_back(std::move(pendingTopic));
+            continue;
         }
+
+        least->topics++;
+        batches[{least->client, pendingTopic.account.get()}].push_back(
+            std::move(pendingTopic));
     }
 
-    return false;
+    this->pendingTopics_ = std::move(leftOver);
+
+    for (auto &batch : batches)
+    {
+        auto &pendingTopics = batch.second;
+
+        std::vector<std::string> topics;
+        for (const auto &pendingTopic : pendingTopics)
+        {
+            topics.push_back(pendingTopic.topic);
+        }
+
+        if (!batch.first.first->listen(topics, pendingTopics[0].account))
+        {
+            this->pendingTopics_.insert(this->pendingTopics_.end(),
+                                        pendingTopics.begin(),
+                                        pendingTopics.end());
+        }
+    }
 }
 
-bool PubSub::isListeningToTopic(const std::string &topic)
+// Opens connections ahead of time so every client stays at
+// targetListensPerClient.
+void PubSub::openConnections()
 {
+    int topics = int(this->pendingTopics_.size());
     for (const auto &p : this->clients)
     {
-        const auto &client = p.second;
-        if (client->isListeningToTopic(topic))
+        topics += p.second->getTopicCount();
+    }
+
+    int needed = std::min<int>(
+        (topics + targetListensPerClient - 1) / targetListensPerClient,
+        MAX_PUBSUB_CONNECTIONS);
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < this->nextConnect_)
+    {
+        // backOff queued another flush
+        return;
+    }
+
+    while (int(this->clients.size()) + this->connecting_ < needed)
+    {
+        auto before = this->connecting_;
+        this->addClient();
+
+        if (this->connecting_ == before)
         {
-            return true;
+            break;
         }
     }
+}
 
-    return false;
+// Delays new connections after a failure, exponentially with jitter so
+// clients don't retry in lockstep.
+void PubSub::backOff()
+{
+    static std::mt19937 gen{std::random_device{}()};
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+
+    auto delay = std::min<std::chrono::milliseconds>(
+        minReconnectDelay * (1 << std::min(this->failedConnects_, 8)),
+        maxReconnectDelay);
+    delay = std::chrono::milliseconds(
+        std::chrono::milliseconds::rep(delay.count() * jitter(gen)));
+
+    this->failedConnects_++;
+    this->nextConnect_ = std::chrono::steady_clock::now() + delay;
+
+    log("Reconnecting to PubSub in {}ms", delay.count());
+
+    runAfter(this->websocketClient.get_io_service(), delay,
+             [this](auto) { this->flushPendingTopics(); });
+}
+
+void PubSub::updateStats()
+{
+    std::vector<ClientStats> stats;
+
+    for (const auto &p : this->clients)
+    {
+        const auto &client = p.second;
+        client->updateMessageRate(statsInterval);
+
+        stats.push_back({client->getTopicCount(), client->getMessageRate()});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->statsMutex_);
+        this->clientStats_ = std::move(stats);
+    }
+
+    runAfter(this->websocketClient.get_io_service(), statsInterval,
+             [this](auto) { this->updateStats(); });
 }
 
 void PubSub::onMessage(websocketpp::connection_hdl hdl,
@@ -667,6 +916,12 @@ void PubSub::onMessage(websocketpp::connection_hdl hdl,
 {
     const std::string &payload = websocketMessage->get_payload();
 
+    auto clientIt = this->clients.find(hdl);
+    if (clientIt != this->clients.end())
+    {
+        clientIt->second->countMessage();
+    }
+
     rapidjson::Document msg;
 
     rapidjson::ParseResult res = msg.Parse(payload.c_str());
@@ -718,8 +973,6 @@ void PubSub::onMessage(websocketpp::connection_hdl hdl,
     }
     else if (type == "PONG")
     {
-        auto clientIt = this->clients.find(hdl);
-
         // If this assert goes off, there's something wrong with the connection
         // creation/preserving code KKona
         assert(clientIt != this->clients.end());
@@ -745,6 +998,11 @@ void PubSub::onConnectionOpen(WebsocketHandle hdl)
 
     this->clients.emplace(hdl, client);
 
+    this->connecting_--;
+    this->failedConnects_ = 0;
+
+    this->flushPendingTopics();
+
     this->connected.invoke();
 }
 
@@ -760,11 +1018,29 @@ void PubSub::onConnectionClose(WebsocketHandle hdl)
 
     client->stop();
 
+    // the topics are spread over the remaining clients and a new connection
+    for (auto &listener : client->takeListeners())
+    {
+        this->pendingTopics_.push_back(
+            {std::move(listener.topic), std::move(listener.account)});
+    }
+
     this->clients.erase(clientIt);
 
+    this->backOff();
+
     this->connected.invoke();
 }
 
+void PubSub::onConnectionFail(WebsocketHandle hdl)
+{
+    log("Unable to connect to PubSub");
+
+    this->connecting_--;
+
+    this->backOff();
+}
+
 PubSub::WebsocketContextPtr PubSub::onTLSInit(websocketpp::connection_hdl hdl)
 {
     WebsocketContextPtr ctx(
@@ -844,13 +1120,14 @@ void PubSub::handleMessageResponse(const rapidjson::Value &outerData)
             return;
         }
 
-        if (whisperType == "whisper_received")
-        {
-            this->signals_.whisper.received.invoke(msg);
-        }
-        else if (whisperType == "whisper_sent")
+        if (whisperType == "whisper_received" || whisperType == "whisper_sent")
         {
-            this->signals_.whisper.sent.invoke(msg);
+            WhisperAction action;
+            action.sent = whisperType == "whisper_sent";
+            action.message =
+                std::make_shared<rapidjson::Document>(std::move(msg));
+
+            this->queueAction(std::move(action));
         }
         else if (whisperType == "thread")
         {
@@ -895,6 +1172,42 @@ void PubSub::handleMessageResponse(const rapidjson::Value &outerData)
     }
 }
 
+void PubSub::queueAction(Action &&action)
+{
+    this->actions_.push(std::move(action));
+
+    if (!this->invokeQueued_.exchange(true))
+    {
+        postToThread([this] { this->invokeActions(); });
+    }
+}
+
+void PubSub::invokeActions()
+{
+    // actions queued from now on need another round. acquire pairs with the
+    // push, release with the next exchange(true) on the pubsub thread
+    this->invokeQueued_.exchange(false, std::memory_order_acq_rel);
+
+    ActionInvoker invoker(this->signals_);
+    Action action;
+
+    for (int i = 0; i < maxActionsPerInvoke; i++)
+    {
+        if (!this->actions_.pop(action))
+        {
+            return;
+        }
+
+        boost::apply_visitor(invoker, action);
+    }
+
+    // leave the rest for the next round
+    if (!this->invokeQueued_.exchange(true))
+    {
+        postToThread([this] { this->invokeActions(); });
+    }
+}
+
 void PubSub::runThread()
 {
     log("Start pubsub manager thread");
@@ -3,17 +3,21 @@
 #include "providers/twitch/PubsubActions.hpp"
 #include "providers/twitch/TwitchAccount.hpp"
 #include "providers/twitch/TwitchServer.hpp"
+#include "util/SpscQueue.hpp"
 
 #include <rapidjson/document.h>
 #include <QString>
+#include <boost/variant.hpp>
 #include <pajlada/signals/signal.hpp>
 #include <websocketpp/client.hpp>
 #include <websocketpp/config/asio_client.hpp>
 
 #include <atomic>
 #include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -34,8 +38,9 @@ namespace detail {
 
     struct Listener {
         std::string topic;
-        bool authed;
-        bool persistent;
+        std::shared_ptr<TwitchAccount> account;
+        bool authed = false;
+        bool persistent = false;
         bool confirmed = false;
     };
 
@@ -48,12 +53,24 @@ namespace detail {
         void start();
         void stop();
 
-        bool listen(rapidjson::Document &message);
+        // sends a single LISTEN message for all topics
+        bool listen(const std::vector<std::string> &topics,
+                    std::shared_ptr<TwitchAccount> account);
         void unlistenPrefix(const std::string &prefix);
 
+        // removes all listeners so they can be moved to another client
+        std::vector<Listener> takeListeners();
+
         void handlePong();
 
         bool isListeningToTopic(const std::string &topic);
+        int getTopicCount() const;
+
+        void countMessage();
+        // computes the message rate from the messages since the last update
+        void updateMessageRate(std::chrono::seconds interval);
+        // messages per minute
+        double getMessageRate() const;
 
     private:
         void ping();
@@ -61,10 +78,12 @@ namespace detail {
 
         WebsocketClient &websocketClient_;
         WebsocketHandle handle_;
-        uint16_t numListens_ = 0;
 
         std::vector<Listener> listeners_;
 
+        int messageCount_ = 0;
+        double messageRate_ = 0;
+
         std::atomic<bool> awaitingPong_{false};
         std::atomic<bool> started_{false};
     };
@@ -104,6 +123,13 @@ public:
 
     pajlada::Signals::NoArgSignal connected;
 
+    // The messages are decoded on the websocket thread, these signals are
+    // invoked on the gui thread
+    struct ClientStats {
+        int topics;
+        double messagesPerMinute;
+    };
+
     struct {
         struct {
             Signal<ClearChatAction> chatCleared;
@@ -115,8 +141,6 @@ public:
         } moderation;
 
         struct {
-            // Parsing should be done in PubSubManager as well,
-            // but for now we just send the raw data
             Signal<const rapidjson::Value &> received;
             Signal<const rapidjson::Value &> sent;
         } whisper;
@@ -129,21 +153,48 @@ public:
     void listenToChannelModerationActions(
         const QString &channelID, std::shared_ptr<TwitchAccount> account);
 
-    std::vector<std::unique_ptr<rapidjson::Document>> requests;
+    // can be called from any thread, updated every minute
+    std::vector<ClientStats> getClientStats() const;
 
 private:
+    using Action =
+        boost::variant<ClearChatAction, ModeChangedAction,
+                       ModerationStateAction, BanAction, UnbanAction,
+                       WhisperAction>;
+
+    struct PendingTopic {
+        std::string topic;
+        std::shared_ptr<TwitchAccount> account;
+    };
+
+    // Everything below runs on the websocket thread. The public functions
+    // post their work there.
+
     void listenToTopic(const std::string &topic,
                        std::shared_ptr<TwitchAccount> account);
 
-    void listen(rapidjson::Document &&msg);
-    bool tryListen(rapidjson::Document &msg);
-
     bool isListeningToTopic(const std::string &topic);
 
+    void queueFlush();
+    void flushPendingTopics();
+    void openConnections();
     void addClient();
+    void backOff();
+    void updateStats();
 
     State state = State::Connected;
 
+    // topics that are not assigned to a client yet
+    std::deque<PendingTopic> pendingTopics_;
+    bool flushQueued_ = false;
+
+    int connecting_ = 0;
+    int failedConnects_ = 0;
+    std::chrono::steady_clock::time_point nextConnect_;
+
+    mutable std::mutex statsMutex_;
+    std::vector<ClientStats> clientStats_;
+
     std::map<WebsocketHandle, std::shared_ptr<detail::PubSubClient>,
              std::owner_less<WebsocketHandle>>
         clients;
@@ -155,11 +206,21 @@ private:
     void onMessage(websocketpp::connection_hdl hdl, WebsocketMessagePtr msg);
     void onConnectionOpen(websocketpp::connection_hdl hdl);
     void onConnectionClose(websocketpp::connection_hdl hdl);
+    void onConnectionFail(websocketpp::connection_hdl hdl);
     WebsocketContextPtr onTLSInit(websocketpp::connection_hdl hdl);
 
     void handleListenResponse(const rapidjson::Document &msg);
     void handleMessageResponse(const rapidjson::Value &data);
 
+    // called on the websocket thread
+    void queueAction(Action &&action);
+    // called on the gui thread
+    void invokeActions();
+
+    // decoded actions waiting for the gui thread
+    SpscQueue<Action> actions_;
+    std::atomic<bool> invokeQueued_{false};
+
     void runThread();
 };
 
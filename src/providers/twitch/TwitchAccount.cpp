@@ -171,6 +171,15 @@ void TwitchAccount::loadIgnores()
 
                 this->ignores_.insert(ignoredUser);
             }
+
+            auto ids = std::make_shared<std::unordered_set<QString>>();
+            for (const auto &user : this->ignores_)
+            {
+                ids->insert(user.id);
+            }
+            std::atomic_store(
+                &this->ignoredUserIds_,
+                std::shared_ptr<const std::unordered_set<QString>>(ids));
         }
 
         return Success;
@@ -247,6 +256,13 @@ void TwitchAccount::ignoreByID(
                            "User " + targetName + " is already ignored");
                 return Failure;
             }
+
+            auto ids = std::make_shared<std::unordered_set<QString>>(
+                *this->ignoredUserIds_);
+            ids->insert(ignoredUser.id);
+            std::atomic_store(
+                &this->ignoredUserIds_,
+                std::shared_ptr<const std::unordered_set<QString>>(ids));
         }
         onFinished(IgnoreResult_Success,
                    "Successfully ignored user " + targetName);
@@ -296,6 +312,13 @@ void TwitchAccount::unignoreByID(
             std::lock_guard<std::mutex> lock(this->ignoresMutex_);
 
             this->ignores_.erase(ignoredUser);
+
+            auto ids = std::make_shared<std::unordered_set<QString>>(
+                *this->ignoredUserIds_);
+            ids->erase(targetUserID);
+            std::atomic_store(
+                &this->ignoredUserIds_,
+                std::shared_ptr<const std::unordered_set<QString>>(ids));
         }
         onFinished(UnignoreResult_Success,
                    "Successfully unignored user " + targetName);
@@ -395,6 +418,12 @@ std::set<TwitchUser> TwitchAccount::getIgnores() const
     return this->ignores_;
 }
 
+std::shared_ptr<const std::unordered_set<QString>>
+    TwitchAccount::getIgnoredUserIds() const
+{
+    return std::atomic_load(&this->ignoredUserIds_);
+}
+
 void TwitchAccount::loadEmotes()
 {
     log("Loading Twitch emotes for user {}", this->getUserName());
@@ -450,6 +479,7 @@ void TwitchAccount::parseEmotes(const rapidjson::Document &root)
 
     emoteData->emoteSets.clear();
     emoteData->allEmoteNames.clear();
+    emoteData->generation++;
 
     auto emoticonSets = root.FindMember("emoticon_sets");
     if (emoticonSets == root.MemberEnd() || !emoticonSets->value.IsObject())
@@ -6,14 +6,17 @@
 #include "controllers/accounts/Account.hpp"
 #include "messages/Emote.hpp"
 #include "providers/twitch/TwitchUser.hpp"
+#include "util/QStringHash.hpp"
 
 #include <rapidjson/document.h>
 #include <QColor>
 #include <QString>
 
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <unordered_set>
 
 namespace chatterino {
 
@@ -57,6 +60,9 @@ public:
 
         std::vector<EmoteName> allEmoteNames;
 
+        // changes every time the emotes are reloaded
+        uint64_t generation = 0;
+
         EmoteMap emotes;
     };
 
@@ -104,6 +110,9 @@ public:
                       std::function<void()> successCallback);
 
     std::set<TwitchUser> getIgnores() const;
+    // ids of the ignored users, can be read from any thread without copying
+    std::shared_ptr<const std::unordered_set<QString>> getIgnoredUserIds()
+        const;
 
     void loadEmotes();
     AccessGuard<const TwitchAccountEmoteData> accessEmotes() const;
@@ -121,6 +130,9 @@ private:
 
     mutable std::mutex ignoresMutex_;
     std::set<TwitchUser> ignores_;
+    // replaced (not modified) whenever ignores_ changes
+    std::shared_ptr<const std::unordered_set<QString>> ignoredUserIds_ =
+        std::make_shared<const std::unordered_set<QString>>();
 
     //    std::map<UserId, TwitchAccountEmoteData> emotes;
     UniqueAccess<TwitchAccountEmoteData> emotes_;
@@ -21,12 +21,15 @@ TwitchAccountManager::TwitchAccountManager()
 
 std::shared_ptr<TwitchAccount> TwitchAccountManager::getCurrent()
 {
-    if (!this->currentUser_)
+    // can be called from the message builder threads
+    auto currentUser = std::atomic_load(&this->currentUser_);
+
+    if (!currentUser)
     {
         return this->anonymousUser_;
     }
 
-    return this->currentUser_;
+    return currentUser;
 }
 
 std::vector<QString> TwitchAccountManager::getUsernames() const
@@ -145,13 +148,13 @@ void TwitchAccountManager::load()
             log("[AccountManager:currentUsernameChanged] User successfully "
                 "updated to {}",
                 newUsername);
-            this->currentUser_ = user;
+            std::atomic_store(&this->currentUser_, user);
         }
         else
         {
             log("[AccountManager:currentUsernameChanged] User successfully "
                 "updated to anonymous");
-            this->currentUser_ = this->anonymousUser_;
+            std::atomic_store(&this->currentUser_, this->anonymousUser_);
         }
 
         this->currentUserChanged.invoke();
@@ -160,14 +163,16 @@ void TwitchAccountManager::load()
 
 bool TwitchAccountManager::isLoggedIn() const
 {
-    if (!this->currentUser_)
+    auto currentUser = std::atomic_load(&this->currentUser_);
+
+    if (!currentUser)
     {
         return false;
     }
 
     // Once `TwitchAccount` class has a way to check, we should also return
     // false if the credentials are incorrect
-    return !this->currentUser_->isAnon();
+    return !currentUser->isAnon();
 }
 
 bool TwitchAccountManager::removeUser(TwitchAccount *account)
@@ -17,6 +17,7 @@
 #include "singletons/Settings.hpp"
 #include "singletons/Toasts.hpp"
 #include "singletons/WindowManager.hpp"
+#include "util/JsonSaxHandler.hpp"
 #include "util/PostToThread.hpp"
 #include "widgets/Window.hpp"
 
@@ -57,25 +58,40 @@ namespace {
 
         return messages;
     }
-    std::pair<Outcome, UsernameSet> parseChatters(const QJsonObject &jsonRoot)
+    // big channels have hundreds of thousands of chatters, so the names are
+    // read straight from the json without building a document
+    class ChattersHandler : public JsonSaxHandler<ChattersHandler>
     {
-        static QStringList categories = {"moderators", "staff", "admins",
-                                         "global_mods", "viewers"};
+    public:
+        bool value(const char *str, size_t length)
+        {
+            static std::vector<std::string> categories = {
+                "moderators", "staff", "admins", "global_mods", "viewers"};
+
+            if (this->isAt({"chatters", nullptr, ""}) &&
+                std::find(categories.begin(), categories.end(),
+                          this->path()[1]) != categories.end())
+            {
+                this->usernames.push_back(
+                    QString::fromUtf8(str, int(length)));
+            }
 
-        auto usernames = UsernameSet();
+            return true;
+        }
 
-        // parse json
-        QJsonObject jsonCategories = jsonRoot.value("chatters").toObject();
+        std::vector<QString> usernames;
+    };
 
-        for (const auto &category : categories)
+    std::pair<Outcome, UsernameSet> parseChatters(const NetworkResult &result)
+    {
+        ChattersHandler handler;
+
+        if (!result.parseJsonSax(handler))
         {
-            for (auto jsonCategory : jsonCategories.value(category).toArray())
-            {
-                usernames.insert(jsonCategory.toString());
-            }
+            return {Failure, UsernameSet()};
         }
 
-        return {Success, std::move(usernames)};
+        return {Success, UsernameSet(handler.usernames)};
     }
 }  // namespace
 
@@ -250,6 +266,8 @@ void TwitchChannel::addRecentChatter(const MessagePtr &message)
 
 void TwitchChannel::addJoinedUser(const QString &user)
 {
+    this->chatters_.access()->insert(user);
+
     auto app = getApp();
     if (user == app->accounts->twitch.getCurrent()->getUserName() ||
         !getSettings()->showJoins.getValue())
@@ -279,6 +297,8 @@ void TwitchChannel::addJoinedUser(const QString &user)
 
 void TwitchChannel::addPartedUser(const QString &user)
 {
+    this->chatters_.access()->remove(user);
+
     auto app = getApp();
 
     if (user == app->accounts->twitch.getCurrent()->getUserName() ||
@@ -582,6 +602,7 @@ void TwitchChannel::loadRecentMessages()
     NetworkRequest request(genericURL.arg(this->roomId()));
     request.makeAuthorizedV5(getDefaultClientID());
     request.setCaller(QThread::currentThread());
+    request.setPriority(NetworkRequestPriority::High);
     // can't be concurrent right now due to SignalVector
     //    request.setExecuteConcurrently(true);
 
@@ -640,7 +661,7 @@ void TwitchChannel::refreshChatters()
             if (!shared)
                 return Failure;
 
-            auto pair = parseChatters(result.parseJson());
+            auto pair = parseChatters(result);
             if (pair.first)
             {
                 *this->chatters_.access() = std::move(pair.second);
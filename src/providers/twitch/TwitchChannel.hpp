@@ -130,7 +130,7 @@ private:
     const QString popoutPlayerUrl_;
     UniqueAccess<StreamStatus> streamStatus_;
     UniqueAccess<RoomModes> roomModes_;
-    UniqueAccess<UsernameSet> chatters_;  // maps 2 char prefix to set of names
+    UniqueAccess<UsernameSet> chatters_;
 
     // Emotes
     TwitchBadges &globalTwitchBadges_;
@@ -0,0 +1,161 @@
+#include "providers/twitch/TwitchIrcLine.hpp"
+
+namespace chatterino {
+namespace {
+    // returns the part before the separator and removes it and the separator
+    // from text
+    std::string_view take(std::string_view &text, char separator)
+    {
+        auto pos = text.find(separator);
+        auto part = text.substr(0, pos);
+
+        text.remove_prefix(pos == std::string_view::npos ? text.size()
+                                                         : pos + 1);
+
+        return part;
+    }
+
+    template <typename Func>
+    void forEachTag(std::string_view rawTags, Func &&func)
+    {
+        while (!rawTags.empty())
+        {
+            auto value = take(rawTags, ';');
+            auto key = take(value, '=');
+
+            func(key, value);
+        }
+    }
+}  // namespace
+
+bool TwitchIrcLine::parse(std::string_view line)
+{
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+    {
+        line.remove_suffix(1);
+    }
+
+    if (!line.empty() && line.front() == '@')
+    {
+        line.remove_prefix(1);
+        this->rawTags = take(line, ' ');
+    }
+
+    if (!line.empty() && line.front() == ':')
+    {
+        line.remove_prefix(1);
+        this->prefix = take(line, ' ');
+    }
+
+    this->command = take(line, ' ');
+    this->params = line;
+
+    forEachTag(this->rawTags, [this](auto key, auto value) {
+        // compare the length first, most tags have none of these lengths
+        switch (key.size())
+        {
+            case 2:
+                if (key == "id")
+                    this->tags.id = value;
+                break;
+
+            case 5:
+                if (key == "color")
+                    this->tags.color = value;
+                break;
+
+            case 6:
+                if (key == "badges")
+                    this->tags.badges = value;
+                else if (key == "emotes")
+                    this->tags.emotes = value;
+                break;
+
+            case 7:
+                if (key == "room-id")
+                    this->tags.roomId = value;
+                else if (key == "user-id")
+                    this->tags.userId = value;
+                break;
+
+            case 11:
+                if (key == "tmi-sent-ts")
+                    this->tags.tmiSentTs = value;
+                break;
+
+            case 12:
+                if (key == "display-name")
+                    this->tags.displayName = value;
+                break;
+        }
+    });
+
+    return !this->command.empty();
+}
+
+boost::optional<std::string_view> TwitchIrcLine::findTag(
+    std::string_view name) const
+{
+    boost::optional<std::string_view> result;
+
+    forEachTag(this->rawTags, [&](auto key, auto value) {
+        if (!result && key == name)
+        {
+            result = value;
+        }
+    });
+
+    return result;
+}
+
+QString TwitchIrcLine::decodeTag(std::string_view value)
+{
+    // most values don't contain escapes
+    if (value.find('\\') == std::string_view::npos)
+    {
+        return QString::fromUtf8(value.data(), int(value.size()));
+    }
+
+    std::string output;
+    output.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        if (value[i] != '\\' || i + 1 == value.size())
+        {
+            output += value[i];
+            continue;
+        }
+
+        switch (value[++i])
+        {
+            case 'n':
+                output += '\n';
+                break;
+
+            case 'r':
+                output += '\r';
+                break;
+
+            case 's':
+                output += ' ';
+                break;
+
+            case '\\':
+                output += '\\';
+                break;
+
+            case ':':
+                output += ';';
+                break;
+
+            default:
+                output += value[i];
+                break;
+        }
+    }
+
+    return QString::fromStdString(output);
+}
+
+}  // namespace chatterino
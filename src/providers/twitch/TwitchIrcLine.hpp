@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+#include <boost/optional.hpp>
+
+#include <string_view>
+
+namespace chatterino {
+
+// Splits a raw irc line from Twitch without copying anything, all views point
+// into the line. The tags Twitch sends with (almost) every chat message get a
+// slot, the others are found with findTag.
+struct TwitchIrcLine {
+    struct Tags {
+        boost::optional<std::string_view> badges;
+        boost::optional<std::string_view> color;
+        boost::optional<std::string_view> displayName;
+        boost::optional<std::string_view> emotes;
+        boost::optional<std::string_view> id;
+        boost::optional<std::string_view> roomId;
+        boost::optional<std::string_view> tmiSentTs;
+        boost::optional<std::string_view> userId;
+    };
+
+    std::string_view rawTags;
+    std::string_view prefix;
+    std::string_view command;
+    std::string_view params;
+
+    Tags tags;
+
+    // returns false if the line has no command
+    bool parse(std::string_view line);
+
+    // the value is still escaped, see decodeTag
+    boost::optional<std::string_view> findTag(std::string_view name) const;
+
+    // undoes the IRCv3 tag value escaping
+    static QString decodeTag(std::string_view value);
+};
+
+}  // namespace chatterino
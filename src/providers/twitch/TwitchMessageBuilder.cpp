@@ -1,9 +1,12 @@
 #include "providers/twitch/TwitchMessageBuilder.hpp"
 
 #include "Application.hpp"
+#include "common/Common.hpp"
 #include "controllers/accounts/AccountController.hpp"
 #include "controllers/highlights/HighlightController.hpp"
+#include "controllers/highlights/HighlightMatcher.hpp"
 #include "controllers/ignores/IgnoreController.hpp"
+#include "debug/AssertInGuiThread.hpp"
 #include "debug/Log.hpp"
 #include "messages/Message.hpp"
 #include "providers/LinkResolver.hpp"
@@ -16,7 +19,8 @@
 #include "singletons/Settings.hpp"
 #include "singletons/Theme.hpp"
 #include "singletons/WindowManager.hpp"
-#include "util/IrcHelpers.hpp"
+#include "util/PostToThread.hpp"
+#include "util/StringInterner.hpp"
 #include "widgets/Window.hpp"
 
 #include <QApplication>
@@ -26,19 +30,64 @@
 #include <boost/variant.hpp>
 
 namespace chatterino {
+namespace {
+    // Images for the badges we ship ourselves. Pixmaps can only be used on the
+    // gui thread, so they are created once from the constructor and only the
+    // images are shared with the builder threads.
+    struct ResourceBadges {
+        ImagePtr staff;
+        ImagePtr admin;
+        ImagePtr globalmod;
+        ImagePtr moderator;
+        ImagePtr turbo;
+        ImagePtr broadcaster;
+        ImagePtr prime;
+        ImagePtr verified;
+        ImagePtr subscriber;
+    };
+
+    const ResourceBadges &resourceBadges()
+    {
+        static ResourceBadges badges = [] {
+            assertInGuiThread();
+
+            auto &twitch = getApp()->resources->twitch;
+
+            return ResourceBadges{
+                Image::fromPixmap(twitch.staff),
+                Image::fromPixmap(twitch.admin),
+                Image::fromPixmap(twitch.globalmod),
+                Image::fromPixmap(twitch.moderator),
+                Image::fromPixmap(twitch.turbo),
+                Image::fromPixmap(twitch.broadcaster),
+                Image::fromPixmap(twitch.prime),
+                Image::fromPixmap(twitch.verified, 0.25),
+                Image::fromPixmap(twitch.subscriber, 0.25),
+            };
+        }();
+
+        return badges;
+    }
+}  // namespace
 
 TwitchMessageBuilder::TwitchMessageBuilder(
     Channel *_channel, const Communi::IrcPrivateMessage *_ircMessage,
     const MessageParseArgs &_args)
     : channel(_channel)
     , twitchChannel(dynamic_cast<TwitchChannel *>(_channel))
-    , ircMessage(_ircMessage)
     , args(_args)
-    , tags(this->ircMessage->tags())
     , originalMessage_(_ircMessage->content())
+    , ircNick_(_ircMessage->nick())
     , action_(_ircMessage->isAction())
+    , rawLine_(_ircMessage->toData())
 {
+    this->line_.parse(
+        std::string_view(this->rawLine_.constData(),
+                         size_t(this->rawLine_.size())));
+
     this->usernameColor_ = getApp()->themes->messages.textColors.system;
+
+    resourceBadges();
 }
 
 TwitchMessageBuilder::TwitchMessageBuilder(
@@ -46,44 +95,42 @@ TwitchMessageBuilder::TwitchMessageBuilder(
     const MessageParseArgs &_args, QString content, bool isAction)
     : channel(_channel)
     , twitchChannel(dynamic_cast<TwitchChannel *>(_channel))
-    , ircMessage(_ircMessage)
     , args(_args)
-    , tags(this->ircMessage->tags())
     , originalMessage_(content)
+    , ircNick_(_ircMessage->nick())
     , action_(isAction)
+    , rawLine_(_ircMessage->toData())
 {
+    this->line_.parse(
+        std::string_view(this->rawLine_.constData(),
+                         size_t(this->rawLine_.size())));
+
     this->usernameColor_ = getApp()->themes->messages.textColors.system;
+
+    resourceBadges();
 }
 
 bool TwitchMessageBuilder::isIgnored() const
 {
     auto app = getApp();
 
-    // TODO(pajlada): Do we need to check if the phrase is valid first?
-    for (const auto &phrase : app->ignores->phrases.getVector())
+    if (auto phrase = app->ignores->findBlockingPhrase(this->originalMessage_))
     {
-        if (phrase.isBlock() && phrase.isMatch(this->originalMessage_))
-        {
-            log("Blocking message because it contains ignored phrase {}",
-                phrase.getPattern());
-            return true;
-        }
+        log("Blocking message because it contains ignored phrase {}",
+            phrase->getPattern());
+        return true;
     }
 
-    if (getSettings()->enableTwitchIgnoredUsers &&
-        this->tags.contains("user-id"))
+    if (getSettings()->enableTwitchIgnoredUsers && this->line_.tags.userId)
     {
-        auto sourceUserID = this->tags.value("user-id").toString();
+        auto sourceUserID =
+            TwitchIrcLine::decodeTag(this->line_.tags.userId.get());
 
-        for (const auto &user :
-             app->accounts->twitch.getCurrent()->getIgnores())
+        if (app->ignores->isBlockedUser(sourceUserID))
         {
-            if (sourceUserID == user.id)
-            {
-                log("Blocking message because it's from blocked user {}",
-                    user.name);
-                return true;
-            }
+            log("Blocking message because it's from blocked user id {}",
+                sourceUserID);
+            return true;
         }
     }
 
@@ -110,11 +157,13 @@ MessagePtr TwitchMessageBuilder::build()
     this->appendChannelName();
 
     // timestamp
-    bool isPastMsg = this->tags.contains("historical");
+    bool isPastMsg = bool(this->line_.findTag("historical"));
     if (isPastMsg)
     {
         // This may be architecture dependent(datatype)
-        qint64 ts = this->tags.value("tmi-sent-ts").toLongLong();
+        qint64 ts = TwitchIrcLine::decodeTag(
+                        this->line_.tags.tmiSentTs.value_or(""))
+                        .toLongLong();
         QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(ts);
         this->emplace<TimestampElement>(dateTime.time());
     }
@@ -130,10 +179,9 @@ MessagePtr TwitchMessageBuilder::build()
     }
     else
     {
-        bool hasUserType = this->tags.contains("user-type");
-        if (hasUserType)
+        if (auto userTypeTag = this->line_.findTag("user-type"))
         {
-            QString userType = this->tags.value("user-type").toString();
+            QString userType = TwitchIrcLine::decodeTag(userTypeTag.get());
 
             if (userType == "mod")
             {
@@ -160,8 +208,7 @@ MessagePtr TwitchMessageBuilder::build()
     this->parseHighlights(isPastMsg);
 
     //    QString bits;
-    auto iterator = this->tags.find("bits");
-    if (iterator != this->tags.end())
+    if (this->line_.findTag("bits"))
     {
         this->hasBits_ = true;
         //        bits = iterator.value().toString();
@@ -170,10 +217,10 @@ MessagePtr TwitchMessageBuilder::build()
     // twitch emotes
     std::vector<std::tuple<int, EmotePtr, EmoteName>> twitchEmotes;
 
-    iterator = this->tags.find("emotes");
-    if (iterator != this->tags.end())
+    if (auto emotesTag = this->line_.tags.emotes)
     {
-        QStringList emoteString = iterator.value().toString().split('/');
+        QStringList emoteString =
+            TwitchIrcLine::decodeTag(emotesTag.get()).split('/');
 
         for (QString emote : emoteString)
         {
@@ -181,7 +228,7 @@ MessagePtr TwitchMessageBuilder::build()
         }
     }
     auto app = getApp();
-    const auto &phrases = app->ignores->phrases.getVector();
+    auto phrases = app->ignores->phrases.readOnly();
     auto removeEmotesInRange =
         [](int pos, int len,
            std::vector<std::tuple<int, EmotePtr, EmoteName>>
@@ -244,7 +291,7 @@ MessagePtr TwitchMessageBuilder::build()
         }
     };
 
-    for (const auto &phrase : phrases)
+    for (const auto &phrase : *phrases)
     {
         if (phrase.isBlock())
         {
@@ -544,27 +591,37 @@ void TwitchMessageBuilder::addTextOrEmoji(const QString &string_)
                                        textColor)
                 ->setLink(link);
 
-        LinkResolver::getLinkInfo(
-            linkString,
-            [weakMessage = this->weakOf(), linkMELowercase, linkMEOriginal,
-             linkString](QString tooltipText, Link originalLink) {
-                auto shared = weakMessage.lock();
-                if (!shared)
-                {
-                    return;
-                }
-                if (!tooltipText.isEmpty())
-                {
-                    linkMELowercase->setTooltip(tooltipText);
-                    linkMEOriginal->setTooltip(tooltipText);
-                }
-                if (originalLink.value != linkString &&
-                    !originalLink.value.isEmpty())
-                {
-                    linkMELowercase->setLink(originalLink)->updateLink();
-                    linkMEOriginal->setLink(originalLink)->updateLink();
-                }
-            });
+        // the request has to be started from the gui thread, the builder
+        // might be running on a worker thread
+        postToThread([weakMessage = this->weakOf(), linkMELowercase,
+                      linkMEOriginal, linkString] {
+            if (weakMessage.expired())
+            {
+                return;
+            }
+
+            LinkResolver::getLinkInfo(
+                linkString,
+                [weakMessage, linkMELowercase, linkMEOriginal, linkString](
+                    QString tooltipText, Link originalLink) {
+                    auto shared = weakMessage.lock();
+                    if (!shared)
+                    {
+                        return;
+                    }
+                    if (!tooltipText.isEmpty())
+                    {
+                        linkMELowercase->setTooltip(tooltipText);
+                        linkMEOriginal->setTooltip(tooltipText);
+                    }
+                    if (originalLink.value != linkString &&
+                        !originalLink.value.isEmpty())
+                    {
+                        linkMELowercase->setLink(originalLink)->updateLink();
+                        linkMEOriginal->setLink(originalLink)->updateLink();
+                    }
+                });
+        });
     }
 
     // if (!linkString.isEmpty()) {
@@ -604,11 +661,9 @@ void TwitchMessageBuilder::addTextOrEmoji(const QString &string_)
 
 void TwitchMessageBuilder::parseMessageID()
 {
-    auto iterator = this->tags.find("id");
-
-    if (iterator != this->tags.end())
+    if (auto id = this->line_.tags.id)
     {
-        this->messageID = iterator.value().toString();
+        this->messageID = TwitchIrcLine::decodeTag(id.get());
     }
 }
 
@@ -619,15 +674,22 @@ void TwitchMessageBuilder::parseRoomID()
         return;
     }
 
-    auto iterator = this->tags.find("room-id");
-
-    if (iterator != std::end(this->tags))
+    if (auto roomId = this->line_.tags.roomId)
     {
-        this->roomID_ = iterator.value().toString();
+        this->roomID_ = TwitchIrcLine::decodeTag(roomId.get());
 
         if (this->twitchChannel->roomId().isEmpty())
         {
-            this->twitchChannel->setRoomId(this->roomID_);
+            // setRoomId invokes signals, so it has to happen on the gui thread
+            auto weak = chatterino::weakOf<Channel>(this->twitchChannel);
+
+            postToThread([weak, roomID = this->roomID_] {
+                if (auto shared = weak.lock())
+                {
+                    static_cast<TwitchChannel *>(shared.get())
+                        ->setRoomId(roomID);
+                }
+            });
         }
     }
 }
@@ -644,27 +706,28 @@ void TwitchMessageBuilder::appendChannelName()
 
 void TwitchMessageBuilder::parseUsername()
 {
-    auto iterator = this->tags.find("color");
-    if (iterator != this->tags.end())
+    if (auto color = this->line_.tags.color)
     {
-        this->usernameColor_ = QColor(iterator.value().toString());
+        this->usernameColor_ = QColor(TwitchIrcLine::decodeTag(color.get()));
     }
 
     // username
-    this->userName = this->ircMessage->nick();
+    this->userName = this->ircNick_;
 
     if (this->userName.isEmpty() || this->args.trimSubscriberUsername)
     {
-        this->userName = this->tags.value(QLatin1String("login")).toString();
+        this->userName = TwitchIrcLine::decodeTag(
+            this->line_.findTag("login").value_or(""));
     }
 
     // display name
-    //    auto displayNameVariant = this->tags.value("display-name");
+    //    auto displayNameVariant = this->line_.tags.displayName;
     //    if (displayNameVariant.isValid()) {
     //        this->userName = displayNameVariant.toString() + " (" +
     //        this->userName + ")";
     //    }
 
+    this->userName = internString(this->userName);
     this->message().loginName = this->userName;
 }
 
@@ -676,11 +739,10 @@ void TwitchMessageBuilder::appendUsername()
     this->message().loginName = username;
     QString localizedName;
 
-    auto iterator = this->tags.find("display-name");
-    if (iterator != this->tags.end())
+    if (auto displayNameTag = this->line_.tags.displayName)
     {
-        QString displayName =
-            parseTagString(iterator.value().toString()).trimmed();
+        QString displayName = internString(
+            TwitchIrcLine::decodeTag(displayNameTag.get()).trimmed());
 
         if (QString::compare(displayName, this->userName,
                              Qt::CaseInsensitive) == 0)
@@ -782,6 +844,9 @@ void TwitchMessageBuilder::appendUsername()
             usernameText += ":";
         }
 
+        // every message of the user has the same one
+        usernameText = internString(usernameText);
+
         this->emplace<TextElement>(usernameText, MessageElementFlag::Username,
                                    this->usernameColor_,
                                    FontStyle::ChatMediumBold)
@@ -791,116 +856,44 @@ void TwitchMessageBuilder::appendUsername()
 
 void TwitchMessageBuilder::parseHighlights(bool isPastMsg)
 {
-    static auto player = new QMediaPlayer;
-    static QUrl currentPlayerUrl;
-
     auto app = getApp();
 
     auto currentUser = app->accounts->twitch.getCurrent();
 
     QString currentUsername = currentUser->getUserName();
 
-    if (this->ircMessage->nick() == currentUsername)
+    if (this->ircNick_ == currentUsername)
     {
         currentUser->setColor(this->usernameColor_);
         // Do nothing. Highlights cannot be triggered by yourself
         return;
     }
 
-    // update the media player url if necessary
-    QUrl highlightSoundUrl;
-    if (getSettings()->customHighlightSound)
-    {
-        highlightSoundUrl =
-            QUrl::fromLocalFile(getSettings()->pathHighlightSound.getValue());
-    }
-    else
-    {
-        highlightSoundUrl = QUrl("qrc:/sounds/ping2.wav");
-    }
-
-    if (currentPlayerUrl != highlightSoundUrl)
-    {
-        player->setMedia(highlightSoundUrl);
-
-        currentPlayerUrl = highlightSoundUrl;
-    }
-
-    // TODO: This vector should only be rebuilt upon highlights being changed
-    // fourtf: should be implemented in the HighlightsController
-    std::vector<HighlightPhrase> activeHighlights =
-        app->highlights->phrases.getVector();
-    std::vector<HighlightPhrase> userHighlights =
-        app->highlights->highlightedUsers.getVector();
-
-    if (getSettings()->enableSelfHighlight && currentUsername.size() > 0)
-    {
-        HighlightPhrase selfHighlight(
-            currentUsername, getSettings()->enableSelfHighlightTaskbar,
-            getSettings()->enableSelfHighlightSound, false);
-        activeHighlights.emplace_back(std::move(selfHighlight));
-    }
+    auto phraseMatcher = app->highlights->getPhraseMatcher();
+    auto userMatcher = app->highlights->getUserMatcher();
 
     bool doHighlight = false;
     bool playSound = false;
     bool doAlert = false;
 
-    bool hasFocus = (QApplication::focusWidget() != nullptr);
-
-    if (!app->highlights->blacklistContains(this->ircMessage->nick()))
+    if (!app->highlights->blacklistContains(this->ircNick_))
     {
-        for (const HighlightPhrase &highlight : activeHighlights)
+        for (const HighlightPhrase *highlight :
+             phraseMatcher->match(this->originalMessage_))
         {
-            if (highlight.isMatch(this->originalMessage_))
-            {
-                log("Highlight because {} matches {}", this->originalMessage_,
-                    highlight.getPattern());
-                doHighlight = true;
-
-                if (highlight.getAlert())
-                {
-                    doAlert = true;
-                }
-
-                if (highlight.getSound())
-                {
-                    playSound = true;
-                }
-
-                if (playSound && doAlert)
-                {
-                    // Break if no further action can be taken from other
-                    // highlights This might change if highlights can have
-                    // custom colors/sounds/actions
-                    break;
-                }
-            }
+            log("Highlight because {} matches {}", this->originalMessage_,
+                highlight->getPattern());
+            doHighlight = true;
+            doAlert |= highlight->getAlert();
+            playSound |= highlight->getSound();
         }
-        for (const HighlightPhrase &userHighlight : userHighlights)
+        for (const HighlightPhrase *userHighlight :
+             userMatcher->match(this->ircNick_))
         {
-            if (userHighlight.isMatch(this->ircMessage->nick()))
-            {
-                log("Highlight because user {} sent a message",
-                    this->ircMessage->nick());
-                doHighlight = true;
-
-                if (userHighlight.getAlert())
-                {
-                    doAlert = true;
-                }
-
-                if (userHighlight.getSound())
-                {
-                    playSound = true;
-                }
-
-                if (playSound && doAlert)
-                {
-                    // Break if no further action can be taken from other
-                    // usernames Mostly used for regex stuff
-                    break;
-                }
-            }
+            log("Highlight because user {} sent a message", this->ircNick_);
+            doHighlight = true;
+            doAlert |= userHighlight->getAlert();
+            playSound |= userHighlight->getSound();
         }
         if (this->args.isReceivedWhisper &&
             getSettings()->enableWhisperHighlight)
@@ -919,18 +912,52 @@ void TwitchMessageBuilder::parseHighlights(bool isPastMsg)
 
         if (!isPastMsg)
         {
-            if (playSound &&
-                (!hasFocus || getSettings()->highlightAlwaysPlaySound))
+            this->highlightSound_ = playSound;
+            this->highlightAlert_ = doAlert;
+        }
+    }
+}
+
+void TwitchMessageBuilder::triggerHighlights()
+{
+    assertInGuiThread();
+
+    static auto player = new QMediaPlayer;
+    static QUrl currentPlayerUrl;
+
+    if (this->highlightSound_)
+    {
+        bool hasFocus = (QApplication::focusWidget() != nullptr);
+
+        if (!hasFocus || getSettings()->highlightAlwaysPlaySound)
+        {
+            // update the media player url if necessary
+            QUrl highlightSoundUrl;
+            if (getSettings()->customHighlightSound)
             {
-                player->play();
+                highlightSoundUrl = QUrl::fromLocalFile(
+                    getSettings()->pathHighlightSound.getValue());
+            }
+            else
+            {
+                highlightSoundUrl = QUrl("qrc:/sounds/ping2.wav");
             }
 
-            if (doAlert)
+            if (currentPlayerUrl != highlightSoundUrl)
             {
-                getApp()->windows->sendAlert();
+                player->setMedia(highlightSoundUrl);
+
+                currentPlayerUrl = highlightSoundUrl;
             }
+
+            player->play();
         }
     }
+
+    if (this->highlightAlert_)
+    {
+        getApp()->windows->sendAlert();
+    }
 }
 
 void TwitchMessageBuilder::appendTwitchEmote(
@@ -1044,13 +1071,11 @@ void TwitchMessageBuilder::appendTwitchBadges()
         return;
     }
 
-    auto app = getApp();
-
-    auto iterator = this->tags.find("badges");
-    if (iterator == this->tags.end())
+    auto badges = this->line_.tags.badges;
+    if (!badges)
         return;
 
-    for (QString badge : iterator.value().toString().split(','))
+    for (QString badge : TwitchIrcLine::decodeTag(badges.get()).split(','))
     {
         if (badge.startsWith("bits/"))
         {
@@ -1087,21 +1112,21 @@ void TwitchMessageBuilder::appendTwitchBadges()
         else if (badge == "staff/1")
         {
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.staff),
+                    resourceBadges().staff,
                     MessageElementFlag::BadgeGlobalAuthority)
                 ->setTooltip("Twitch Staff");
         }
         else if (badge == "admin/1")
         {
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.admin),
+                    resourceBadges().admin,
                     MessageElementFlag::BadgeGlobalAuthority)
                 ->setTooltip("Twitch Admin");
         }
         else if (badge == "global_mod/1")
         {
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.globalmod),
+                    resourceBadges().globalmod,
                     MessageElementFlag::BadgeGlobalAuthority)
                 ->setTooltip("Twitch Global Moderator");
         }
@@ -1116,29 +1141,28 @@ void TwitchMessageBuilder::appendTwitchBadges()
                 continue;
             }
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.moderator),
+                    resourceBadges().moderator,
                     MessageElementFlag::BadgeChannelAuthority)
                 ->setTooltip("Twitch Channel Moderator");
         }
         else if (badge == "turbo/1")
         {
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.turbo),
+                    resourceBadges().turbo,
                     MessageElementFlag::BadgeGlobalAuthority)
                 ->setTooltip("Twitch Turbo Subscriber");
         }
         else if (badge == "broadcaster/1")
         {
             this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.broadcaster),
+                    resourceBadges().broadcaster,
                     MessageElementFlag::BadgeChannelAuthority)
                 ->setTooltip("Twitch Broadcaster");
         }
         else if (badge == "premium/1")
         {
-            this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.prime),
-                    MessageElementFlag::BadgeVanity)
+            this->emplace<ImageElement>(resourceBadges().prime,
+                                        MessageElementFlag::BadgeVanity)
                 ->setTooltip("Twitch Prime Subscriber");
         }
         else if (badge.startsWith("partner/"))
@@ -1148,10 +1172,8 @@ void TwitchMessageBuilder::appendTwitchBadges()
             {
                 case 1:
                 {
-                    this->emplace<ImageElement>(
-                            Image::fromPixmap(app->resources->twitch.verified,
-                                              0.25),
-                            MessageElementFlag::BadgeVanity)
+                    this->emplace<ImageElement>(resourceBadges().verified,
+                                                MessageElementFlag::BadgeVanity)
                         ->setTooltip("Twitch Verified");
                 }
                 break;
@@ -1176,9 +1198,8 @@ void TwitchMessageBuilder::appendTwitchBadges()
             }
 
             // use default subscriber badge if custom one not found
-            this->emplace<ImageElement>(
-                    Image::fromPixmap(app->resources->twitch.subscriber, 0.25),
-                    MessageElementFlag::BadgeSubscription)
+            this->emplace<ImageElement>(resourceBadges().subscriber,
+                                        MessageElementFlag::BadgeSubscription)
                 ->setTooltip("Twitch Subscriber");
         }
         else
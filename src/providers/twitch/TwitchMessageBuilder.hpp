@@ -3,6 +3,7 @@
 #include "common/Aliases.hpp"
 #include "common/Outcome.hpp"
 #include "messages/MessageBuilder.hpp"
+#include "providers/twitch/TwitchIrcLine.hpp"
 
 #include <IrcMessage>
 #include <QString>
@@ -37,16 +38,20 @@ public:
 
     Channel *channel;
     TwitchChannel *twitchChannel;
-    const Communi::IrcMessage *ircMessage;
     MessageParseArgs args;
-    const QVariantMap tags;
 
     QString messageID;
     QString userName;
 
+    // isIgnored and build only read thread safe state and can be called from
+    // a worker thread. The irc message is not used after the constructor.
     bool isIgnored() const;
     MessagePtr build();
 
+    // plays the highlight sound and flashes the taskbar if the built message
+    // asked for it, must be called on the gui thread
+    void triggerHighlights();
+
 private:
     void parseMessageID();
     void parseRoomID();
@@ -75,9 +80,17 @@ private:
 
     QColor usernameColor_;
     QString originalMessage_;
+    const QString ircNick_;
     bool senderIsBroadcaster{};
 
+    bool highlightAlert_ = false;
+    bool highlightSound_ = false;
+
     const bool action_ = false;
+
+    // the views in line_ point into rawLine_
+    const QByteArray rawLine_;
+    TwitchIrcLine line_;
 };
 
 }  // namespace chatterino
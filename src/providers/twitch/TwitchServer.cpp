@@ -9,16 +9,118 @@
 #include "providers/twitch/TwitchAccount.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "providers/twitch/TwitchHelpers.hpp"
+#include "providers/twitch/TwitchIrcLine.hpp"
 #include "providers/twitch/TwitchMessageBuilder.hpp"
 #include "util/PostToThread.hpp"
 
 #include <IrcCommand>
+#include <array>
 #include <cassert>
+#include <string_view>
 
 // using namespace Communi;
 using namespace std::chrono_literals;
 
 namespace chatterino {
+namespace {
+    using CommandHandler = void (*)(TwitchServer &, Communi::IrcMessage *);
+
+    struct Command {
+        std::string_view name;
+        CommandHandler handler = nullptr;
+    };
+
+    // PRIVMSG goes through privateMessageReceived
+    constexpr Command commands[] = {
+        {"ROOMSTATE",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleRoomStateMessage(message);
+         }},
+        {"CLEARCHAT",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleClearChatMessage(message);
+         }},
+        {"USERSTATE",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleUserStateMessage(message);
+         }},
+        {"WHISPER",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleWhisperMessage(message);
+         }},
+        {"USERNOTICE",
+         [](TwitchServer &server, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleUserNoticeMessage(message,
+                                                                      server);
+         }},
+        {"MODE",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleModeMessage(message);
+         }},
+        {"NOTICE",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleNoticeMessage(
+                 static_cast<Communi::IrcNoticeMessage *>(message));
+         }},
+        {"JOIN",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handleJoinMessage(message);
+         }},
+        {"PART",
+         [](TwitchServer &, Communi::IrcMessage *message) {
+             IrcMessageHandler::getInstance().handlePartMessage(message);
+         }},
+    };
+
+    // Perfect hash for the commands above, checked by the static_assert
+    // below. Pick new factors if a command is added and it fails.
+    constexpr size_t commandTableSize = 12;
+
+    constexpr size_t hashCommand(std::string_view command)
+    {
+        if (command.size() < 2)
+        {
+            return 0;
+        }
+
+        return (2 * size_t(command[0]) + 4 * size_t(command[1]) +
+                command.size()) %
+               commandTableSize;
+    }
+
+    constexpr bool commandHashesCollide()
+    {
+        for (size_t i = 0; i < std::size(commands); i++)
+        {
+            for (size_t j = i + 1; j < std::size(commands); j++)
+            {
+                if (hashCommand(commands[i].name) ==
+                    hashCommand(commands[j].name))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    static_assert(!commandHashesCollide(), "command hashes collide");
+
+    constexpr std::array<Command, commandTableSize> makeCommandTable()
+    {
+        std::array<Command, commandTableSize> table{};
+
+        for (const auto &command : commands)
+        {
+            table[hashCommand(command.name)] = command;
+        }
+
+        return table;
+    }
+
+    constexpr auto commandTable = makeCommandTable();
+}  // namespace
 
 TwitchServer::TwitchServer()
     : whispersChannel(new Channel("/whispers", Channel::Type::TwitchWhispers))
@@ -111,46 +213,20 @@ void TwitchServer::messageReceived(Communi::IrcMessage *message)
         return;
     }
 
-    const QString &command = message->command();
-
-    auto &handler = IrcMessageHandler::getInstance();
+    auto data = message->toData();
 
-    if (command == "ROOMSTATE")
-    {
-        handler.handleRoomStateMessage(message);
-    }
-    else if (command == "CLEARCHAT")
-    {
-        handler.handleClearChatMessage(message);
-    }
-    else if (command == "USERSTATE")
-    {
-        handler.handleUserStateMessage(message);
-    }
-    else if (command == "WHISPER")
-    {
-        handler.handleWhisperMessage(message);
-    }
-    else if (command == "USERNOTICE")
-    {
-        handler.handleUserNoticeMessage(message, *this);
-    }
-    else if (command == "MODE")
-    {
-        handler.handleModeMessage(message);
-    }
-    else if (command == "NOTICE")
+    TwitchIrcLine line;
+    if (!line.parse(std::string_view(data.constData(), size_t(data.size()))))
     {
-        handler.handleNoticeMessage(
-            static_cast<Communi::IrcNoticeMessage *>(message));
-    }
-    else if (command == "JOIN")
-    {
-        handler.handleJoinMessage(message);
+        return;
     }
-    else if (command == "PART")
+
+    // one hash and one string comparison per line
+    const auto &command = commandTable[hashCommand(line.command)];
+
+    if (command.handler != nullptr && command.name == line.command)
     {
-        handler.handlePartMessage(message);
+        command.handler(*this, message);
     }
 }
 
@@ -2,8 +2,6 @@
 
 #include "common/Singleton.hpp"
 
-#define GIF_FRAME_LENGTH 33
-
 #include "providers/bttv/BttvEmotes.hpp"
 #include "providers/emoji/Emojis.hpp"
 #include "providers/ffz/FfzEmotes.hpp"
@@ -22,6 +22,9 @@
 #endif
 
 namespace chatterino {
+namespace {
+    const size_t maxCachedWordWidths = 50000;
+}  // namespace
 
 Fonts::Fonts()
     : chatFontFamily("/appearance/currentFontFamily", DEFAULT_FONT_FAMILY)
@@ -36,10 +39,7 @@ void Fonts::initialize(Settings &, Paths &)
         [this]() {
             assertInGuiThread();
 
-            for (auto &map : this->fontsByType_)
-            {
-                map.clear();
-            }
+            this->clearFontData();
             this->fontChanged.invoke();
         },
         false);
@@ -48,10 +48,7 @@ void Fonts::initialize(Settings &, Paths &)
         [this]() {
             assertInGuiThread();
 
-            for (auto &map : this->fontsByType_)
-            {
-                map.clear();
-            }
+            this->clearFontData();
             this->fontChanged.invoke();
         },
         false);
@@ -62,15 +59,22 @@ void Fonts::initialize(Settings &, Paths &)
 
             getApp()->windows->incGeneration();
 
-            for (auto &map : this->fontsByType_)
-            {
-                map.clear();
-            }
+            this->clearFontData();
             this->fontChanged.invoke();
         },
         false);
 }
 
+void Fonts::clearFontData()
+{
+    for (auto &map : this->fontsByType_)
+    {
+        map.clear();
+    }
+
+    this->generation_++;
+}
+
 QFont Fonts::getFont(FontStyle type, float scale)
 {
     return this->getOrCreateFontData(type, scale).font;
@@ -81,6 +85,33 @@ QFontMetrics Fonts::getFontMetrics(FontStyle type, float scale)
     return this->getOrCreateFontData(type, scale).metrics;
 }
 
+int Fonts::getWordWidth(FontStyle type, float scale, const QString &word)
+{
+    auto &data = this->getOrCreateFontData(type, scale);
+
+    auto it = data.wordWidths.find(word);
+    if (it != data.wordWidths.end())
+    {
+        return it->second;
+    }
+
+    // most words are only seen once, start over instead of growing forever
+    if (data.wordWidths.size() >= maxCachedWordWidths)
+    {
+        data.wordWidths.clear();
+    }
+
+    auto width = data.metrics.width(word);
+    data.wordWidths.emplace(word, width);
+
+    return width;
+}
+
+int Fonts::getGeneration() const
+{
+    return this->generation_;
+}
+
 Fonts::FontData &Fonts::getOrCreateFontData(FontStyle type, float scale)
 {
     assertInGuiThread();
@@ -2,6 +2,7 @@
 
 #include "common/ChatterinoSetting.hpp"
 #include "common/Singleton.hpp"
+#include "util/QStringHash.hpp"
 
 #include <QFont>
 #include <QFontDatabase>
@@ -50,6 +51,12 @@ public:
     QFont getFont(FontStyle type, float scale);
     QFontMetrics getFontMetrics(FontStyle type, float scale);
 
+    // measured widths are cached until the font changes
+    int getWordWidth(FontStyle type, float scale, const QString &word);
+
+    // increases every time the fonts change
+    int getGeneration() const;
+
     QStringSetting chatFontFamily;
     IntSetting chatFontSize;
 
@@ -65,6 +72,7 @@ private:
 
         const QFont font;
         const QFontMetrics metrics;
+        std::unordered_map<QString, int> wordWidths;
     };
 
     struct ChatFontData {
@@ -82,8 +90,10 @@ private:
 
     FontData &getOrCreateFontData(FontStyle type, float scale);
     FontData createFontData(FontStyle type, float scale);
+    void clearFontData();
 
     std::vector<std::unordered_map<float, FontData>> fontsByType_;
+    int generation_ = 0;
 };
 
 }  // namespace chatterino
@@ -4,16 +4,58 @@
 #include "debug/Log.hpp"
 #include "singletons/Paths.hpp"
 #include "singletons/Settings.hpp"
+#include "util/DebugCount.hpp"
 
+#include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QStandardPaths>
 
-#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <vector>
 
 namespace chatterino {
+namespace {
+    // the gui thread waits for the writer once this many messages are queued
+    const size_t maxQueueSize = 10000;
+
+    // how long written lines may sit in the buffers of the channels
+    const std::chrono::milliseconds flushInterval(1000);
+}  // namespace
+
+Logging::~Logging()
+{
+    this->stopWriter();
+}
 
 void Logging::initialize(Settings &settings, Paths &paths)
 {
+    settings.logPath.connect([this, &paths](const QString &logPath, auto) {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+
+        if (logPath.isEmpty())
+        {
+            this->baseDirectory_ = paths.messageLogDirectory;
+        }
+        else
+        {
+            this->baseDirectory_ = logPath;
+        }
+
+        this->baseDirectoryChanged_ = true;
+        this->entriesAdded_.notify_one();
+    });
+
+    this->writer_ = std::thread([this] { this->runWriter(); });
+}
+
+void Logging::save()
+{
+    // writes out everything that's still buffered
+    this->stopWriter();
 }
 
 void Logging::addMessage(const QString &channelName, MessagePtr message)
@@ -23,17 +65,206 @@ void Logging::addMessage(const QString &channelName, MessagePtr message)
         return;
     }
 
-    auto it = this->loggingChannels_.find(channelName);
-    if (it == this->loggingChannels_.end())
+    auto timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+
+    if (this->queue_.size() >= maxQueueSize && !this->quit_)
+    {
+        DebugCount::increase("log writer stalls");
+
+        this->entriesTaken_.wait(lock, [this] {
+            return this->queue_.size() < maxQueueSize || this->quit_;
+        });
+    }
+
+    if (this->quit_)
+    {
+        return;
+    }
+
+    this->queue_.push_back({channelName, timestamp, message->searchText});
+    DebugCount::increase("log queue");
+
+    if (this->queue_.size() == 1)
+    {
+        this->entriesAdded_.notify_one();
+    }
+}
+
+std::vector<LogLine> Logging::search(const LogQuery &query)
+{
+    QString baseDirectory;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        baseDirectory = this->baseDirectory_;
+    }
+
+    QDir directory(baseDirectory + QDir::separator() +
+                   LoggingChannel::generateSubDirectory(query.channelName));
+
+    // "<channel>-yyyy-MM-dd.log", newest day first
+    auto fileNames =
+        directory.entryList({query.channelName + "-*.log"}, QDir::Files,
+                            QDir::Name | QDir::Reversed);
+
+    std::vector<LogLine> lines;
+    LogIndex index;
+    QTime time;
+    LogLine line;
+
+    // only load the parts of the indexes the query needs
+    bool withUsers = !query.userName.isEmpty();
+    bool withTerms = !LogIndex::splitTerms(query.text).isEmpty();
+
+    // these aren't indexed, so the lines are checked for them
+    auto shortTerms = LogIndex::splitShortTerms(query.text);
+
+    for (const auto &fileName : fileNames)
+    {
+        if (int(lines.size()) >= query.limit)
+        {
+            break;
+        }
+
+        auto date = QDate::fromString(
+            fileName.mid(query.channelName.size() + 1, 10), "yyyy-MM-dd");
+        if (!date.isValid())
+        {
+            continue;
+        }
+
+        auto path = directory.filePath(fileName);
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            continue;
+        }
+
+        index.load(path, withUsers, withTerms);
+        auto offsets = index.find(query.userName, query.text);
+
+        for (auto it = offsets.rbegin();
+             it != offsets.rend() && int(lines.size()) < query.limit; it++)
+        {
+            if (!file.seek(*it))
+            {
+                continue;
+            }
+
+            auto text = QString::fromUtf8(file.readLine()).trimmed();
+            if (!LogIndex::parseLine(text, time, line.userName, line.text) ||
+                !LogIndex::containsTerms(line.text, shortTerms))
+            {
+                continue;
+            }
+
+            line.time = QDateTime(date, time);
+            lines.push_back(line);
+        }
+    }
+
+    std::reverse(lines.begin(), lines.end());
+
+    return lines;
+}
+
+void Logging::runWriter()
+{
+    std::vector<Entry> batch;
+    QString baseDirectory;
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+
+    while (true)
+    {
+        bool baseDirectoryChanged = false;
+        bool quit = false;
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+
+            this->entriesAdded_.wait_for(lock, flushInterval, [this] {
+                return !this->queue_.empty() || this->baseDirectoryChanged_ ||
+                       this->quit_;
+            });
+
+            batch.assign(std::make_move_iterator(this->queue_.begin()),
+                         std::make_move_iterator(this->queue_.end()));
+            this->queue_.clear();
+
+            if (this->baseDirectoryChanged_)
+            {
+                baseDirectory = this->baseDirectory_;
+                baseDirectoryChanged = true;
+                this->baseDirectoryChanged_ = false;
+            }
+
+            quit = this->quit_;
+        }
+
+        if (!batch.empty())
+        {
+            DebugCount::decrease("log queue", int64_t(batch.size()));
+            this->entriesTaken_.notify_all();
+        }
+
+        if (baseDirectoryChanged)
+        {
+            for (auto &&channel : this->loggingChannels_)
+            {
+                channel.second->setBaseDirectory(baseDirectory);
+            }
+        }
+
+        for (auto &entry : batch)
+        {
+            auto &channel = this->loggingChannels_[entry.channelName];
+            if (!channel)
+            {
+                channel.reset(
+                    new LoggingChannel(entry.channelName, baseDirectory));
+            }
+
+            channel->addMessage(
+                QDateTime::fromMSecsSinceEpoch(entry.timestamp),
+                entry.text);
+        }
+        batch.clear();
+
+        if (quit)
+        {
+            // the destructors write the closing lines and flush
+            this->loggingChannels_.clear();
+            return;
+        }
+
+        if (sinceFlush.elapsed() >= flushInterval.count())
+        {
+            for (auto &&channel : this->loggingChannels_)
+            {
+                channel.second->flush();
+            }
+
+            sinceFlush.restart();
+        }
+    }
+}
+
+void Logging::stopWriter()
+{
     {
-        auto channel = new LoggingChannel(channelName);
-        channel->addMessage(message);
-        this->loggingChannels_.emplace(
-            channelName, std::unique_ptr<LoggingChannel>(std::move(channel)));
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->quit_ = true;
     }
-    else
+
+    this->entriesAdded_.notify_one();
+    this->entriesTaken_.notify_all();
+
+    if (this->writer_.joinable())
     {
-        it->second->addMessage(message);
+        this->writer_.join();
     }
 }
 
@@ -5,24 +5,77 @@
 #include "messages/Message.hpp"
 #include "singletons/helper/LoggingChannel.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace chatterino {
 
 class Paths;
 
+struct LogQuery {
+    QString channelName;
+
+    // both are optional, every word in text has to be in a line for it to
+    // match. Words are matched whole and case insensitive.
+    QString userName;
+    QString text;
+
+    int limit = 500;
+};
+
+struct LogLine {
+    QDateTime time;
+    QString userName;
+    QString text;
+};
+
+// Messages are handed to a writer thread which formats them and writes them
+// to the log files in batches. The gui thread only has to push them into a
+// bounded queue.
 class Logging : public Singleton
 {
     Paths *pathManager = nullptr;
 
 public:
     Logging() = default;
+    ~Logging() override;
 
     virtual void initialize(Settings &settings, Paths &paths) override;
+    virtual void save() override;
 
     void addMessage(const QString &channelName, MessagePtr message);
 
+    // Returns the newest lines of the local logs that match the query, oldest
+    // first. Reads the files, so don't call it from the gui thread.
+    std::vector<LogLine> search(const LogQuery &query);
+
 private:
+    struct Entry {
+        QString channelName;
+        qint64 timestamp;
+        // copied on the gui thread, messages must not be released elsewhere
+        QString text;
+    };
+
+    void runWriter();
+    void stopWriter();
+
+    std::thread writer_;
+
+    std::mutex mutex_;
+    std::condition_variable entriesAdded_;
+    std::condition_variable entriesTaken_;
+    std::deque<Entry> queue_;
+    QString baseDirectory_;
+    bool baseDirectoryChanged_ = false;
+    bool quit_ = false;
+
+    // only accessed from the writer thread
     std::map<QString, std::unique_ptr<LoggingChannel>> loggingChannels_;
 };
 
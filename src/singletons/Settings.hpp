@@ -193,6 +193,8 @@ public:
     QStringSetting currentVersion = {"/misc/currentVersion", ""};
 
     QStringSetting cachePath = {"/cache/path", ""};
+    // decoded images above this limit get dropped if they aren't visible
+    IntSetting imageMemoryLimit = {"/cache/imageMemoryLimitMB", 512};
 
     void saveSnapshot();
     void restoreSnapshot();
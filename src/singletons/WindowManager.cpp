@@ -174,6 +174,12 @@ void WindowManager::forceLayoutChannelViews()
     this->layoutChannelViews(nullptr);
 }
 
+void WindowManager::layoutImages(
+    const std::unordered_set<const Image *> &images)
+{
+    this->imagesChanged.invoke(images);
+}
+
 void WindowManager::repaintVisibleChatWidgets(Channel *channel)
 {
     if (this->mainWindow_ != nullptr)
@@ -5,9 +5,12 @@
 #include "common/Singleton.hpp"
 #include "widgets/splits/SplitContainer.hpp"
 
+#include <unordered_set>
+
 namespace chatterino {
 
 class Settings;
+class Image;
 class Paths;
 class Window;
 class SplitContainer;
@@ -47,6 +50,10 @@ public:
     // This is called, for example, when the emote scale or timestamp format has
     // changed
     void forceLayoutChannelViews();
+
+    // Tell the channel views to redo the layout of the messages containing
+    // one of the images, e.g. once they finished loading
+    void layoutImages(const std::unordered_set<const Image *> &images);
     void repaintVisibleChatWidgets(Channel *channel = nullptr);
     void repaintGifEmotes();
 
@@ -73,6 +80,10 @@ public:
     // channel is a nullptr, need to redo their layout
     pajlada::Signals::Signal<Channel *> layout;
 
+    // This signal fires with images whose size or content changed
+    pajlada::Signals::Signal<const std::unordered_set<const Image *> &>
+        imagesChanged;
+
     pajlada::Signals::NoArgSignal wordFlagsChanged;
 
     // Sends an alert to the main window
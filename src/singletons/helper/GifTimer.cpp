@@ -9,22 +9,36 @@ namespace chatterino {
 void GIFTimer::initialize()
 {
     this->timer.setInterval(30);
+    this->elapsed_.start();
 
     getSettings()->animateEmotes.connect([this](bool enabled, auto) {
         if (enabled)
+        {
+            this->elapsed_.restart();
             this->timer.start();
+        }
         else
             this->timer.stop();
     });
 
     QObject::connect(&this->timer, &QTimer::timeout, [this] {
+        // the time since the last tick only counts if we are animating
+        auto elapsed = this->elapsed_.restart();
+
         if (getSettings()->animationsWhenFocused &&
             qApp->activeWindow() == nullptr)
             return;
 
+        this->position_ += elapsed;
+
         this->signal.invoke();
         getApp()->windows->repaintGifEmotes();
     });
 }
 
+qint64 GIFTimer::position() const
+{
+    return this->position_;
+}
+
 }  // namespace chatterino
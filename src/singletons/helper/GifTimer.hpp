@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QTimer>
 #include <pajlada/signals/signal.hpp>
 
@@ -10,10 +11,16 @@ class GIFTimer
 public:
     void initialize();
 
+    // milliseconds the animations have been running for, stands still while
+    // animations are paused
+    qint64 position() const;
+
     pajlada::Signals::NoArgSignal signal;
 
 private:
     QTimer timer;
+    QElapsedTimer elapsed_;
+    qint64 position_{0};
 };
 
 }  // namespace chatterino
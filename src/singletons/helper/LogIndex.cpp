@@ -0,0 +1,355 @@
+#include "singletons/helper/LogIndex.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+
+#include <algorithm>
+#include <iterator>
+
+namespace chatterino {
+namespace {
+    const quint32 indexMagic = 0x4c4f4749;  // "LOGI"
+    const quint32 indexVersion = 2;
+
+    // shorter terms would have huge posting lists, the lines found for the
+    // other terms are checked for them instead
+    const int minTermLength = 2;
+
+    QString indexPath(const QString &logPath)
+    {
+        return logPath + ".idx";
+    }
+
+    // lowercase words of text
+    QStringList splitWords(const QString &text)
+    {
+        QStringList words;
+        QString word;
+
+        for (int i = 0; i <= text.size(); i++)
+        {
+            if (i < text.size() && text[i].isLetterOrNumber())
+            {
+                word += text[i].toLower();
+                continue;
+            }
+
+            if (!word.isEmpty())
+            {
+                words.push_back(word);
+                word.clear();
+            }
+        }
+
+        return words;
+    }
+
+    // sections are prefixed with their size so they can be skipped
+    template <typename T>
+    void writeSection(QDataStream &stream, const T &value)
+    {
+        QByteArray bytes;
+        QDataStream section(&bytes, QIODevice::WriteOnly);
+        section.setVersion(stream.version());
+        section << value;
+
+        stream << qint64(bytes.size());
+        stream.writeRawData(bytes.constData(), bytes.size());
+    }
+
+    template <typename T>
+    void readSection(QDataStream &stream, T &value, bool skip)
+    {
+        qint64 size = 0;
+        stream >> size;
+
+        if (skip)
+        {
+            if (stream.skipRawData(int(size)) != size)
+            {
+                stream.setStatus(QDataStream::ReadPastEnd);
+            }
+        }
+        else
+        {
+            stream >> value;
+        }
+    }
+}  // namespace
+
+void LogIndex::load(const QString &logPath, bool withUsers, bool withTerms)
+{
+    this->hasUsers_ = withUsers;
+    this->hasTerms_ = withTerms;
+    this->reset();
+
+    QFile indexFile(indexPath(logPath));
+    if (indexFile.open(QIODevice::ReadOnly))
+    {
+        QDataStream stream(&indexFile);
+        stream.setVersion(QDataStream::Qt_5_6);
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+
+        if (magic == indexMagic && version == indexVersion)
+        {
+            stream >> this->logSize_ >> this->lines_;
+            readSection(stream, this->users_, !withUsers);
+            readSection(stream, this->terms_, !withTerms);
+        }
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            this->reset();
+        }
+    }
+
+    QFile logFile(logPath);
+    if (!logFile.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    // the log was replaced by something else, start over
+    if (logFile.size() < this->logSize_)
+    {
+        this->reset();
+    }
+
+    this->indexLines(logFile, this->logSize_);
+}
+
+bool LogIndex::save(const QString &logPath) const
+{
+    if (!this->hasUsers_ || !this->hasTerms_)
+    {
+        return false;
+    }
+
+    QSaveFile file(indexPath(logPath));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    stream << indexMagic << indexVersion << this->logSize_ << this->lines_;
+    writeSection(stream, this->users_);
+    writeSection(stream, this->terms_);
+
+    return file.commit();
+}
+
+void LogIndex::addLine(qint64 offset, const QString &userName,
+                       const QString &text)
+{
+    this->lines_.push_back(offset);
+
+    if (this->hasUsers_ && !userName.isEmpty())
+    {
+        this->users_[userName.toLower()].push_back(offset);
+    }
+
+    if (!this->hasTerms_)
+    {
+        return;
+    }
+
+    auto terms = splitTerms(text);
+    terms.removeDuplicates();
+
+    for (const auto &term : terms)
+    {
+        this->terms_[term].push_back(offset);
+    }
+}
+
+void LogIndex::setLogSize(qint64 logSize)
+{
+    this->logSize_ = logSize;
+}
+
+std::vector<qint64> LogIndex::find(const QString &userName,
+                                   const QString &text) const
+{
+    std::vector<const QVector<qint64> *> lists;
+
+    if (!userName.isEmpty())
+    {
+        auto it = this->users_.find(userName.toLower());
+        if (it == this->users_.end())
+        {
+            return {};
+        }
+
+        lists.push_back(&it.value());
+    }
+
+    for (const auto &term : splitTerms(text))
+    {
+        auto it = this->terms_.find(term);
+        if (it == this->terms_.end())
+        {
+            return {};
+        }
+
+        lists.push_back(&it.value());
+    }
+
+    if (lists.empty())
+    {
+        return std::vector<qint64>(this->lines_.begin(), this->lines_.end());
+    }
+
+    // intersect starting with the shortest list
+    std::sort(lists.begin(), lists.end(),
+              [](auto a, auto b) { return a->size() < b->size(); });
+
+    std::vector<qint64> result(lists.front()->begin(), lists.front()->end());
+    std::vector<qint64> intersection;
+
+    for (size_t i = 1; i < lists.size() && !result.empty(); i++)
+    {
+        intersection.clear();
+        std::set_intersection(result.begin(), result.end(), lists[i]->begin(),
+                              lists[i]->end(),
+                              std::back_inserter(intersection));
+        result.swap(intersection);
+    }
+
+    return result;
+}
+
+bool LogIndex::parseLine(const QString &line, QTime &time, QString &userName,
+                         QString &text)
+{
+    // "[HH:mm:ss] "
+    if (line.size() < 11 || line[0] != '[' || line[9] != ']')
+    {
+        return false;
+    }
+
+    time = QTime::fromString(line.mid(1, 8), "HH:mm:ss");
+    if (!time.isValid())
+    {
+        return false;
+    }
+
+    splitUserName(line.mid(11), userName, text);
+
+    return true;
+}
+
+void LogIndex::splitUserName(const QString &message, QString &userName,
+                             QString &text)
+{
+    userName.clear();
+    text = message;
+
+    // system messages don't start with a username
+    auto colon = message.indexOf(": ");
+    if (colon <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < colon; i++)
+    {
+        auto c = message[i];
+        if (!c.isLetterOrNumber() && c != '_')
+        {
+            return;
+        }
+    }
+
+    userName = message.left(colon);
+    text = message.mid(colon + 2);
+}
+
+QStringList LogIndex::splitTerms(const QString &text)
+{
+    auto terms = splitWords(text);
+    terms.erase(std::remove_if(terms.begin(), terms.end(),
+                               [](const QString &term) {
+                                   return term.size() < minTermLength;
+                               }),
+                terms.end());
+
+    return terms;
+}
+
+QStringList LogIndex::splitShortTerms(const QString &text)
+{
+    auto terms = splitWords(text);
+    terms.erase(std::remove_if(terms.begin(), terms.end(),
+                               [](const QString &term) {
+                                   return term.size() >= minTermLength;
+                               }),
+                terms.end());
+    terms.removeDuplicates();
+
+    return terms;
+}
+
+bool LogIndex::containsTerms(const QString &text, const QStringList &terms)
+{
+    if (terms.isEmpty())
+    {
+        return true;
+    }
+
+    auto words = splitWords(text);
+
+    return std::all_of(terms.begin(), terms.end(), [&](const QString &term) {
+        return words.contains(term);
+    });
+}
+
+void LogIndex::reset()
+{
+    bool hasUsers = this->hasUsers_;
+    bool hasTerms = this->hasTerms_;
+
+    *this = LogIndex();
+    this->hasUsers_ = hasUsers;
+    this->hasTerms_ = hasTerms;
+}
+
+void LogIndex::indexLines(QFile &file, qint64 from)
+{
+    if (!file.seek(from))
+    {
+        return;
+    }
+
+    QTime time;
+    QString userName;
+    QString text;
+
+    while (true)
+    {
+        auto offset = file.pos();
+        auto line = file.readLine();
+
+        // only index complete lines, the rest might still be written
+        if (!line.endsWith('\n'))
+        {
+            this->logSize_ = offset;
+            break;
+        }
+
+        if (parseLine(QString::fromUtf8(line).trimmed(), time, userName,
+                      text))
+        {
+            this->addLine(offset, userName, text);
+        }
+    }
+}
+
+}  // namespace chatterino
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTime>
+#include <QVector>
+
+#include <vector>
+
+class QFile;
+
+namespace chatterino {
+
+// Index over the lines of one log file, saved next to it as "<file>.idx".
+//
+// The log file itself stays the append-only table of messages. The index
+// maps the offsets of its lines to the (lowercase) usernames and terms in
+// them. Lines that were appended after the index was saved, e.g. because the
+// application crashed, are indexed again when it's loaded.
+//
+// The usernames and terms are saved in sections of their own, so a search
+// that doesn't need one of them skips it instead of reading it.
+class LogIndex
+{
+public:
+    // loads the saved index of the log file and indexes everything that was
+    // written to the log file after it was saved, the usernames and terms
+    // are only loaded if they're wanted
+    void load(const QString &logPath, bool withUsers = true,
+              bool withTerms = true);
+
+    // the index must cover the whole log file and be loaded completely
+    bool save(const QString &logPath) const;
+
+    void addLine(qint64 offset, const QString &userName, const QString &text);
+    void setLogSize(qint64 logSize);
+
+    // offsets of the lines sent by userName, if it's not empty, which contain
+    // all the terms in text that splitTerms() returns, the lines still have
+    // to be checked for the ones splitShortTerms() returns
+    std::vector<qint64> find(const QString &userName,
+                             const QString &text) const;
+
+    // splits "[HH:mm:ss] username: text" into its parts
+    static bool parseLine(const QString &line, QTime &time, QString &userName,
+                          QString &text);
+
+    // splits "username: text", userName is empty for system messages
+    static void splitUserName(const QString &message, QString &userName,
+                              QString &text);
+
+    // the terms of text that are indexed
+    static QStringList splitTerms(const QString &text);
+
+    // the terms of text that are too short to be indexed
+    static QStringList splitShortTerms(const QString &text);
+
+    // whether all the terms are words of text
+    static bool containsTerms(const QString &text, const QStringList &terms);
+
+private:
+    void indexLines(QFile &file, qint64 from);
+
+    // empties the index but keeps which sections are loaded
+    void reset();
+
+    bool hasUsers_ = true;
+    bool hasTerms_ = true;
+
+    qint64 logSize_ = 0;
+
+    QVector<qint64> lines_;
+    QHash<QString, QVector<qint64>> users_;
+    QHash<QString, QVector<qint64>> terms_;
+};
+
+}  // namespace chatterino
@@ -1,9 +1,6 @@
 #include "LoggingChannel.hpp"
 
-#include "Application.hpp"
 #include "debug/Log.hpp"
-#include "singletons/Paths.hpp"
-#include "singletons/Settings.hpp"
 
 #include <QDir>
 
@@ -13,60 +10,90 @@ namespace chatterino {
 
 QByteArray endline("\n");
 
-LoggingChannel::LoggingChannel(const QString &_channelName)
+namespace {
+    // write the buffer out once it gets this big, in bytes
+    const int maxBufferSize = 64 * 1024;
+}  // namespace
+
+LoggingChannel::LoggingChannel(const QString &_channelName,
+                               const QString &baseDirectory)
     : channelName(_channelName)
+    , baseDirectory(baseDirectory)
+    , subDirectory(generateSubDirectory(_channelName))
+{
+    this->openLogFile(QDateTime::currentDateTime());
+}
+
+LoggingChannel::~LoggingChannel()
 {
-    if (this->channelName.startsWith("/whispers"))
+    this->appendLine(this->generateClosingString());
+    this->closeLogFile();
+}
+
+QString LoggingChannel::generateSubDirectory(const QString &channelName)
+{
+    QString subDirectory;
+
+    if (channelName.startsWith("/whispers"))
     {
-        this->subDirectory = "Whispers";
+        subDirectory = "Whispers";
     }
     else if (channelName.startsWith("/mentions"))
     {
-        this->subDirectory = "Mentions";
+        subDirectory = "Mentions";
     }
     else
     {
-        this->subDirectory =
+        subDirectory =
             QStringLiteral("Channels") + QDir::separator() + channelName;
     }
 
     // FOURTF: change this when adding more providers
-    this->subDirectory = "Twitch/" + this->subDirectory;
-
-    auto app = getApp();
+    return "Twitch/" + subDirectory;
+}
 
-    getSettings()->logPath.connect([this](const QString &logPath, auto) {
-        auto app = getApp();
+void LoggingChannel::setBaseDirectory(const QString &baseDirectory)
+{
+    this->baseDirectory = baseDirectory;
+    this->openLogFile(QDateTime::currentDateTime());
+}
 
-        if (logPath.isEmpty())
-        {
-            this->baseDirectory = getPaths()->messageLogDirectory;
-        }
-        else
-        {
-            this->baseDirectory = logPath;
-        }
+void LoggingChannel::flush()
+{
+    if (this->buffer.isEmpty())
+    {
+        return;
+    }
 
-        this->openLogFile();
-    });
+    this->fileHandle.write(this->buffer);
+    this->fileHandle.flush();
+    this->writtenSize += this->buffer.size();
+    this->buffer.clear();
 }
 
-LoggingChannel::~LoggingChannel()
+void LoggingChannel::closeLogFile()
 {
-    this->appendLine(this->generateClosingString());
+    if (!this->fileHandle.isOpen())
+    {
+        return;
+    }
+
+    this->flush();
+
+    this->index.setLogSize(this->writtenSize);
+    if (!this->index.save(this->fileHandle.fileName()))
+    {
+        log("Unable to save log index of {}", this->fileHandle.fileName());
+    }
+
     this->fileHandle.close();
 }
 
-void LoggingChannel::openLogFile()
+void LoggingChannel::openLogFile(const QDateTime &now)
 {
-    QDateTime now = QDateTime::currentDateTime();
     this->dateString = this->generateDateString(now);
 
-    if (this->fileHandle.isOpen())
-    {
-        this->fileHandle.flush();
-        this->fileHandle.close();
-    }
+    this->closeLogFile();
 
     QString baseFileName = this->channelName + "-" + this->dateString + ".log";
 
@@ -86,28 +113,34 @@ void LoggingChannel::openLogFile()
 
     this->fileHandle.open(QIODevice::Append);
 
+    // picks up whatever earlier sessions wrote to the file today
+    this->index.load(fileName);
+    this->writtenSize = this->fileHandle.size();
+
     this->appendLine(this->generateOpeningString(now));
 }
 
-void LoggingChannel::addMessage(MessagePtr message)
+void LoggingChannel::addMessage(const QDateTime &time, const QString &text)
 {
-    QDateTime now = QDateTime::currentDateTime();
-
-    QString messageDateString = this->generateDateString(now);
-    if (messageDateString != this->dateString)
+    if (this->generateDateString(time) != this->dateString)
     {
-        this->dateString = messageDateString;
-        this->openLogFile();
+        this->openLogFile(time);
     }
 
     QString str;
     str.append('[');
-    str.append(now.toString("HH:mm:ss"));
+    str.append(time.toString("HH:mm:ss"));
     str.append("] ");
 
-    str.append(message->searchText);
+    str.append(text);
     str.append(endline);
 
+    QString userName;
+    QString messageText;
+    LogIndex::splitUserName(text, userName, messageText);
+    this->index.addLine(this->writtenSize + this->buffer.size(), userName,
+                        messageText);
+
     this->appendLine(str);
 }
 
@@ -135,8 +168,12 @@ QString LoggingChannel::generateClosingString(const QDateTime &now) const
 
 void LoggingChannel::appendLine(const QString &line)
 {
-    this->fileHandle.write(line.toUtf8());
-    this->fileHandle.flush();
+    this->buffer.append(line.toUtf8());
+
+    if (this->buffer.size() >= maxBufferSize)
+    {
+        this->flush();
+    }
 }
 
 QString LoggingChannel::generateDateString(const QDateTime &now)
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "messages/Message.hpp"
+#include "singletons/helper/LogIndex.hpp"
 
+#include <QByteArray>
 #include <QDateTime>
 #include <QFile>
 #include <QString>
@@ -13,16 +15,25 @@ namespace chatterino {
 
 class Logging;
 
+// Only used from the writer thread of Logging. Lines are collected in a
+// buffer which is written out when it gets big or when flush() is called.
 class LoggingChannel : boost::noncopyable
 {
-    explicit LoggingChannel(const QString &_channelName);
+    LoggingChannel(const QString &_channelName, const QString &baseDirectory);
 
 public:
     ~LoggingChannel();
-    void addMessage(MessagePtr message);
+    void addMessage(const QDateTime &time, const QString &text);
+
+    void setBaseDirectory(const QString &baseDirectory);
+    void flush();
+
+    // relative to the base directory
+    static QString generateSubDirectory(const QString &channelName);
 
 private:
-    void openLogFile();
+    void openLogFile(const QDateTime &now);
+    void closeLogFile();
 
     QString generateOpeningString(
         const QDateTime &now = QDateTime::currentDateTime()) const;
@@ -38,6 +49,10 @@ private:
     QString subDirectory;
 
     QFile fileHandle;
+    QByteArray buffer;
+    qint64 writtenSize = 0;
+
+    LogIndex index;
 
     QString dateString;
 
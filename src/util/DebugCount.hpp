@@ -13,34 +13,24 @@ namespace chatterino {
 class DebugCount
 {
 public:
-    static void increase(const QString &name)
+    static void increase(const QString &name, int64_t amount = 1)
     {
         auto counts = counts_.access();
 
         auto it = counts->find(name);
         if (it == counts->end())
         {
-            counts->insert(name, 1);
+            counts->insert(name, amount);
         }
         else
         {
-            reinterpret_cast<int64_t &>(it.value())++;
+            reinterpret_cast<int64_t &>(it.value()) += amount;
         }
     }
 
-    static void decrease(const QString &name)
+    static void decrease(const QString &name, int64_t amount = 1)
     {
-        auto counts = counts_.access();
-
-        auto it = counts->find(name);
-        if (it == counts->end())
-        {
-            counts->insert(name, -1);
-        }
-        else
-        {
-            reinterpret_cast<int64_t &>(it.value())--;
-        }
+        increase(name, -amount);
     }
 
     static QString getDebugText()
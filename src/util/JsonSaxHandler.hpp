@@ -0,0 +1,113 @@
+#pragma once
+
+#include <rapidjson/reader.h>
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace chatterino {
+
+// Base for rapidjson SAX handlers that pick a few values out of a large
+// document. It keeps the keys leading to the current value, so the handler
+// can match on the path instead of tracking its own state. Array elements
+// have an empty key.
+//
+// Derived classes implement
+//     bool value(const char *str, size_t length)
+// for strings and numbers (see NetworkResult::parseJsonSax) and
+//     bool objectEnded()
+// which is called with the path of the object that just ended. Returning
+// false stops the parser.
+template <typename Derived>
+class JsonSaxHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Derived>
+{
+public:
+    bool String(const char *str, rapidjson::SizeType length, bool)
+    {
+        return this->derived().value(str, length);
+    }
+
+    bool RawNumber(const char *str, rapidjson::SizeType length, bool)
+    {
+        return this->derived().value(str, length);
+    }
+
+    bool StartObject()
+    {
+        this->path_.emplace_back();
+        return true;
+    }
+
+    bool Key(const char *str, rapidjson::SizeType length, bool)
+    {
+        this->path_.back().assign(str, length);
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        this->path_.pop_back();
+        return this->derived().objectEnded();
+    }
+
+    bool StartArray()
+    {
+        this->path_.emplace_back();
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType)
+    {
+        this->path_.pop_back();
+        return true;
+    }
+
+    bool value(const char *, size_t)
+    {
+        return true;
+    }
+
+    bool objectEnded()
+    {
+        return true;
+    }
+
+protected:
+    const std::vector<std::string> &path() const
+    {
+        return this->path_;
+    }
+
+    // nullptr matches any key
+    bool isAt(std::initializer_list<const char *> path) const
+    {
+        if (path.size() != this->path_.size())
+        {
+            return false;
+        }
+
+        auto it = this->path_.begin();
+        for (auto key : path)
+        {
+            if (key != nullptr && *it != key)
+            {
+                return false;
+            }
+            it++;
+        }
+
+        return true;
+    }
+
+private:
+    Derived &derived()
+    {
+        return static_cast<Derived &>(*this);
+    }
+
+    std::vector<std::string> path_;
+};
+
+}  // namespace chatterino
@@ -0,0 +1,130 @@
+#include "util/PhraseAutomaton.hpp"
+
+#include <cassert>
+#include <queue>
+
+namespace chatterino {
+
+PhraseAutomaton::PhraseAutomaton(Qt::CaseSensitivity caseSensitivity)
+    : caseSensitivity_(caseSensitivity)
+    , nodes_(1)
+{
+}
+
+void PhraseAutomaton::add(const QString &phrase, int id)
+{
+    if (phrase.isEmpty())
+    {
+        return;
+    }
+
+    int state = 0;
+
+    for (QChar c : phrase)
+    {
+        auto key = this->fold(c.unicode());
+        auto it = this->nodes_[state].next.find(key);
+
+        if (it != this->nodes_[state].next.end())
+        {
+            state = it->second;
+            continue;
+        }
+
+        int depth = this->nodes_[state].depth + 1;
+        int child = int(this->nodes_.size());
+
+        this->nodes_[state].next.emplace(key, child);
+        this->nodes_.emplace_back();
+        this->nodes_.back().depth = depth;
+
+        state = child;
+    }
+
+    this->nodes_[state].ids.push_back(id);
+    this->hasPhrases_ = true;
+}
+
+void PhraseAutomaton::build()
+{
+    // breadth first, so the fail target of a node is always done before it
+    std::queue<int> queue;
+
+    if (!this->nodes_[0].ids.empty())
+    {
+        this->nodes_[0].outputNode = 0;
+    }
+
+    for (auto &&edge : this->nodes_[0].next)
+    {
+        this->nodes_[edge.second].fail = 0;
+        queue.push(edge.second);
+    }
+
+    while (!queue.empty())
+    {
+        int state = queue.front();
+        queue.pop();
+
+        auto &node = this->nodes_[state];
+
+        node.outputNode = node.ids.empty() ? this->nodes_[node.fail].outputNode
+                                           : state;
+
+        for (auto &&edge : node.next)
+        {
+            int fail = node.fail;
+
+            while (fail != 0 && !this->nodes_[fail].next.count(edge.first))
+            {
+                fail = this->nodes_[fail].fail;
+            }
+
+            auto it = this->nodes_[fail].next.find(edge.first);
+            this->nodes_[edge.second].fail =
+                it != this->nodes_[fail].next.end() && it->second != edge.second
+                    ? it->second
+                    : 0;
+
+            queue.push(edge.second);
+        }
+    }
+}
+
+bool PhraseAutomaton::isEmpty() const
+{
+    return !this->hasPhrases_;
+}
+
+ushort PhraseAutomaton::fold(ushort c) const
+{
+    if (this->caseSensitivity_ == Qt::CaseSensitive)
+    {
+        return c;
+    }
+
+    return QChar::toCaseFolded(c);
+}
+
+int PhraseAutomaton::step(int state, ushort c) const
+{
+    while (true)
+    {
+        const auto &node = this->nodes_[state];
+        auto it = node.next.find(c);
+
+        if (it != node.next.end())
+        {
+            return it->second;
+        }
+
+        if (state == 0)
+        {
+            return 0;
+        }
+
+        state = node.fail;
+    }
+}
+
+}  // namespace chatterino
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QString>
+
+#include <unordered_map>
+#include <vector>
+
+namespace chatterino {
+
+// Aho-Corasick automaton over the utf-16 code units of a set of phrases.
+// Finds every occurrence of every phrase in a single pass over the subject.
+//
+// Phrases are added with add() and the automaton has to be build() before
+// findAll() can be used. A built automaton is never modified, so it can be
+// shared between threads.
+class PhraseAutomaton
+{
+public:
+    explicit PhraseAutomaton(Qt::CaseSensitivity caseSensitivity);
+
+    // empty phrases are ignored
+    void add(const QString &phrase, int id);
+    void build();
+
+    bool isEmpty() const;
+
+    // calls callback(int id, int start, int length) for every occurrence of a
+    // phrase in subject, ordered by the end of the occurrence.
+    // The callback returns false to stop searching.
+    template <typename Callback>
+    void findAll(const QString &subject, Callback &&callback) const
+    {
+        if (this->isEmpty())
+        {
+            return;
+        }
+
+        int state = 0;
+
+        for (int i = 0; i < subject.size(); i++)
+        {
+            state = this->step(state, this->fold(subject[i].unicode()));
+
+            for (int out = this->nodes_[state].outputNode; out != -1;
+                 out = this->nodes_[this->nodes_[out].fail].outputNode)
+            {
+                const auto &node = this->nodes_[out];
+
+                for (int id : node.ids)
+                {
+                    if (!callback(id, i + 1 - node.depth, node.depth))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Node {
+        std::unordered_map<ushort, int> next;
+        int fail = 0;
+        // closest node (this one included) along the fail links that ends a
+        // phrase, -1 if there is none
+        int outputNode = -1;
+        int depth = 0;
+        std::vector<int> ids;
+    };
+
+    ushort fold(ushort c) const;
+    int step(int state, ushort c) const;
+
+    Qt::CaseSensitivity caseSensitivity_;
+    std::vector<Node> nodes_;
+    bool hasPhrases_ = false;
+};
+
+}  // namespace chatterino
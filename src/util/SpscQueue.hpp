@@ -0,0 +1,70 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+
+namespace chatterino {
+
+// Unbounded lock-free queue for exactly one producer thread and one consumer
+// thread. push may only be called from the producer, pop only from the
+// consumer.
+template <typename T>
+class SpscQueue : boost::noncopyable
+{
+public:
+    SpscQueue()
+        : head_(new Node)
+        , tail_(head_)
+    {
+    }
+
+    ~SpscQueue()
+    {
+        while (this->head_ != nullptr)
+        {
+            auto next = this->head_->next.load(std::memory_order_relaxed);
+            delete this->head_;
+            this->head_ = next;
+        }
+    }
+
+    void push(T value)
+    {
+        auto node = new Node;
+        node->value = std::move(value);
+
+        this->tail_->next.store(node, std::memory_order_release);
+        this->tail_ = node;
+    }
+
+    // returns false if the queue is empty
+    bool pop(T &value)
+    {
+        auto next = this->head_->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        // next becomes the new dummy node
+        value = std::move(next->value);
+        delete this->head_;
+        this->head_ = next;
+
+        return true;
+    }
+
+private:
+    struct Node {
+        T value;
+        std::atomic<Node *> next{nullptr};
+    };
+
+    // dummy node, owned by the consumer
+    Node *head_;
+    // last node, owned by the producer
+    Node *tail_;
+};
+
+}  // namespace chatterino
@@ -0,0 +1,91 @@
+#include "util/StringInterner.hpp"
+
+#include "util/DebugCount.hpp"
+
+namespace chatterino {
+namespace {
+    // shards get cleaned up after this many calls to intern
+    const size_t sweepInterval = 4096;
+
+    // what every copy of the string would take if it wasn't shared
+    int64_t stringSize(const QString &string)
+    {
+        return int64_t(sizeof(QString::Data)) +
+               (string.size() + 1) * int64_t(sizeof(QChar));
+    }
+}  // namespace
+
+StringInterner &StringInterner::getInstance()
+{
+    static StringInterner instance;
+    return instance;
+}
+
+QString StringInterner::intern(const QString &string)
+{
+    if (string.isEmpty())
+    {
+        return string;
+    }
+
+    auto &shard = this->shards_[qHash(string) % this->shards_.size()];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (++shard.internsSinceSweep >= sweepInterval)
+    {
+        this->sweep(shard);
+    }
+
+    auto it = shard.strings.find(string);
+    if (it != shard.strings.end())
+    {
+        return *it;
+    }
+
+    shard.strings.insert(string);
+    DebugCount::increase("interned strings");
+
+    return string;
+}
+
+// shard.mutex must be locked
+void StringInterner::sweep(Shard &shard)
+{
+    shard.internsSinceSweep = 0;
+
+    int64_t savings = 0;
+
+    for (auto it = shard.strings.begin(); it != shard.strings.end();)
+    {
+        // one reference is ours, every other one would be a copy otherwise
+        auto references =
+            const_cast<QString &>(*it).data_ptr()->ref.atomic.load();
+
+        if (references == 1)
+        {
+            it = shard.strings.erase(it);
+            DebugCount::decrease("interned strings");
+            continue;
+        }
+
+        if (references > 2)
+        {
+            savings += (references - 2) * stringSize(*it);
+        }
+
+        it++;
+    }
+
+    savings /= 1024;
+    DebugCount::increase("interned string savings (KB)",
+                         savings - shard.reportedSavings);
+    shard.reportedSavings = savings;
+}
+
+QString internString(const QString &string)
+{
+    return StringInterner::getInstance().intern(string);
+}
+
+}  // namespace chatterino
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "util/QStringHash.hpp"
+
+#include <QString>
+#include <boost/noncopyable.hpp>
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+
+namespace chatterino {
+
+// Hands out shared copies of equal strings, so names that show up in
+// thousands of messages only take up memory once. Can be used from any
+// thread.
+//
+// Strings that are only referenced by the interner are dropped every now and
+// then.
+class StringInterner : boost::noncopyable
+{
+public:
+    static StringInterner &getInstance();
+
+    QString intern(const QString &string);
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<QString> strings;
+        size_t internsSinceSweep = 0;
+        int64_t reportedSavings = 0;
+    };
+
+    StringInterner() = default;
+
+    void sweep(Shard &shard);
+
+    std::array<Shard, 16> shards_;
+};
+
+// shorthand for StringInterner::getInstance().intern(string)
+QString internString(const QString &string);
+
+}  // namespace chatterino
@@ -1,19 +1,31 @@
 #include "LogsPopup.hpp"
 
 #include "IrcMessage"
+#include "Application.hpp"
 #include "common/Channel.hpp"
 #include "common/NetworkRequest.hpp"
 #include "providers/twitch/PartialTwitchUser.hpp"
 #include "providers/twitch/TwitchChannel.hpp"
 #include "providers/twitch/TwitchMessageBuilder.hpp"
+#include "singletons/Logging.hpp"
+#include "util/PostToThread.hpp"
 #include "widgets/helper/ChannelView.hpp"
 
-#include <QDateTime>
 #include <QJsonArray>
 #include <QMessageBox>
+#include <QPointer>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
 namespace chatterino {
+namespace {
+    // a remote line with the same text as a local one this close to it is the
+    // same message
+    const qint64 duplicateWindowSeconds = 10;
+}  // namespace
 
 LogsPopup::LogsPopup()
     : channel_(Channel::getEmpty())
@@ -48,14 +60,138 @@ void LogsPopup::setInfo(ChannelPtr channel, QString userName)
         return;
     }  
 
+    this->setWindowTitle(this->userName_ + "'s logs in #" +
+                         this->channelName_);
+
+    this->getLocalLogs();
+    this->getRemoteLogs();
+}
+
+void LogsPopup::getLocalLogs()
+{
+    LogQuery query;
+    query.channelName = this->channelName_;
+    query.userName = this->userName_;
+
+    QPointer<LogsPopup> self(this);
+
+    QThreadPool::globalInstance()->start(new LambdaRunnable([self, query] {
+        auto lines = getApp()->logging->search(query);
+
+        postToThread([self, lines = std::move(lines)] {
+            if (!self)
+            {
+                return;
+            }
+
+            std::vector<Line> localLines;
+            for (const auto &line : lines)
+            {
+                MessageBuilder builder;
+                builder.emplace<TimestampElement>(line.time.time());
+                builder.emplace<TextElement>(line.userName,
+                                             MessageElementFlag::Username,
+                                             MessageColor::System);
+                builder.emplace<TextElement>(
+                    line.text, MessageElementFlag::Text, MessageColor::Text);
+                localLines.push_back({line.time, line.text, builder.release()});
+            }
+            self->addLines(std::move(localLines), true);
+        });
+    }));
+}
+
+void LogsPopup::getRemoteLogs()
+{
     // Get channel ID.
     PartialTwitchUser::byName(this->channelName_)
         .getId([=](const QString &roomID) {
             this->getLogviewerLogs(roomID); 
         }, this);
+}
 
-    this->setWindowTitle(this->userName_ + "'s logs in #" +
-                         this->channelName_);
+void LogsPopup::addLines(std::vector<Line> lines, bool local)
+{
+    if (local)
+    {
+        this->localLines_ = std::move(lines);
+        this->localDone_ = true;
+    }
+    else
+    {
+        this->remoteLines_ = std::move(lines);
+        this->remoteDone_ = true;
+    }
+
+    this->showLines();
+}
+
+void LogsPopup::showLines()
+{
+    // the log websites usually have the messages we logged ourselves too
+    std::unordered_multimap<QString, qint64> localTimes;
+    for (const auto &line : this->localLines_)
+    {
+        localTimes.emplace(line.text, line.time.toSecsSinceEpoch());
+    }
+
+    std::vector<Line> lines = this->localLines_;
+
+    for (const auto &line : this->remoteLines_)
+    {
+        auto time = line.time.toSecsSinceEpoch();
+        auto range = localTimes.equal_range(line.text);
+
+        if (std::none_of(range.first, range.second, [&](const auto &local) {
+                return std::abs(local.second - time) <=
+                       duplicateWindowSeconds;
+            }))
+        {
+            lines.push_back(line);
+        }
+    }
+
+    if (lines.empty())
+    {
+        if (this->localDone_ && this->remoteDone_)
+        {
+            this->showNoLogsFound();
+        }
+        return;
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const Line &a, const Line &b) {
+                         return a.time < b.time;
+                     });
+
+    std::vector<MessagePtr> messages;
+    messages.reserve(lines.size());
+    for (const auto &line : lines)
+    {
+        messages.push_back(line.message);
+    }
+
+    this->setMessages(messages);
+}
+
+void LogsPopup::showNoLogsFound()
+{
+    auto box = new QMessageBox(
+        QMessageBox::Information, "Error getting logs",
+        "No logs could be found for channel " + this->channelName_);
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    box->show();
+    box->raise();
+
+    static QSet<int> closeButtons {
+        QMessageBox::Ok,
+        QMessageBox::Close,
+    };
+    if (closeButtons.contains(box->exec())) 
+    {
+        this->close();
+    }
 }
 
 void LogsPopup::setMessages(std::vector<MessagePtr> &messages)
@@ -82,7 +218,7 @@ void LogsPopup::getLogviewerLogs(const QString &roomID)
 
     req.onSuccess([this, roomID](auto result) -> Outcome {
         auto data = result.parseJson();
-        std::vector<MessagePtr> messages;
+        std::vector<Line> lines;
 
         QJsonValue before = data.value("before");
 
@@ -103,9 +239,11 @@ void LogsPopup::getLogviewerLogs(const QString &roomID)
             auto privMsg =
                 static_cast<Communi::IrcPrivateMessage *>(ircMessage);
             TwitchMessageBuilder builder(this->channel_.get(), privMsg, args);
-            messages.push_back(builder.build());
+            lines.push_back(
+                {QDateTime::fromSecsSinceEpoch(messageObject["time"].toInt()),
+                 privMsg->content(), builder.build()});
         };
-        this->setMessages(messages);
+        this->addLines(std::move(lines), false);
 
         return Success;
     });
@@ -123,50 +261,36 @@ void LogsPopup::getOverrustleLogs()
     NetworkRequest req(url);
     req.setCaller(QThread::currentThread());
     req.onError([this](int errorCode) {
-        auto box = new QMessageBox(
-            QMessageBox::Information, "Error getting logs",
-            "No logs could be found for channel " + this->channelName_);
-        box->setAttribute(Qt::WA_DeleteOnClose);
-        box->show();
-        box->raise();
-
-        static QSet<int> closeButtons {
-            QMessageBox::Ok,
-            QMessageBox::Close,
-        };
-        if (closeButtons.contains(box->exec())) 
-        {
-            this->close();
-        }
+        // no remote logs, the local ones might still be there
+        this->addLines({}, false);
 
         return true;
     });
 
     req.onSuccess([this](auto result) -> Outcome {
         auto data = result.parseJson();
-        std::vector<MessagePtr> messages;
+        std::vector<Line> lines;
         if (data.contains("lines"))
         {
             QJsonArray dataMessages = data.value("lines").toArray();
             for (auto i : dataMessages)
             {
                 QJsonObject singleMessage = i.toObject();
-                QTime timeStamp = QDateTime::fromSecsSinceEpoch(
-                                      singleMessage.value("timestamp").toInt())
-                                      .time();
+                QDateTime timeStamp = QDateTime::fromSecsSinceEpoch(
+                    singleMessage.value("timestamp").toInt());
+                QString text = singleMessage.value("text").toString();
 
                 MessageBuilder builder;
-                builder.emplace<TimestampElement>(timeStamp);
+                builder.emplace<TimestampElement>(timeStamp.time());
                 builder.emplace<TextElement>(this->userName_,
                                              MessageElementFlag::Username,
                                              MessageColor::System);
-                builder.emplace<TextElement>(
-                    singleMessage.value("text").toString(),
-                    MessageElementFlag::Text, MessageColor::Text);
-                messages.push_back(builder.release());
+                builder.emplace<TextElement>(text, MessageElementFlag::Text,
+                                             MessageColor::Text);
+                lines.push_back({timeStamp, text, builder.release()});
             }
         }
-        this->setMessages(messages);
+        this->addLines(std::move(lines), false);
 
         return Success;
     });
@@ -2,6 +2,8 @@
 
 #include "widgets/BaseWindow.hpp"
 
+#include <QDateTime>
+
 namespace chatterino {
 
 class Channel;
@@ -21,14 +23,32 @@ public:
     void setInfo(std::shared_ptr<Channel> channel, QString userName);
 
 private:
+    struct Line {
+        QDateTime time;
+        QString text;
+        MessagePtr message;
+    };
+
     ChannelView *channelView_ = nullptr;
     ChannelPtr channel_;
 
     QString userName_;
     QString channelName_;
 
+    // the local and the remote logs are shown together, each of them is
+    // merged in when it arrives
+    std::vector<Line> localLines_;
+    std::vector<Line> remoteLines_;
+    bool localDone_ = false;
+    bool remoteDone_ = false;
+
     void initLayout();
+    void addLines(std::vector<Line> lines, bool local);
+    void showLines();
+    void showNoLogsFound();
     void setMessages(std::vector<MessagePtr> &messages);
+    void getLocalLogs();
+    void getRemoteLogs();
     void getOverrustleLogs();
     void getLogviewerLogs(const QString &roomID);
 };
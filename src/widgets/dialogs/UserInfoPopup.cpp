@@ -372,15 +372,8 @@ void UserInfoPopup::updateUserData()
         });
 
         // get ignore state
-        bool isIgnoring = false;
-        for (const auto &ignoredUser : currentUser->getIgnores())
-        {
-            if (id == ignoredUser.id)
-            {
-                isIgnoring = true;
-                break;
-            }
-        }
+        auto ignoredIds = currentUser->getIgnoredUserIds();
+        bool isIgnoring = ignoredIds->find(id) != ignoredIds->end();
 
         // get ignoreHighlights state
         bool isIgnoringHighlights = false;
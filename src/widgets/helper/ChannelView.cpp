@@ -129,6 +129,21 @@ ChannelView::ChannelView(BaseWidget *parent)
     this->clickTimer_ = new QTimer(this);
     this->clickTimer_->setSingleShot(true);
     this->clickTimer_->setInterval(500);
+
+    this->layoutCooldown_ = new QTimer(this);
+    this->layoutCooldown_->setSingleShot(true);
+    this->layoutCooldown_->setInterval(1000 / 60);
+    QObject::connect(this->layoutCooldown_, &QTimer::timeout, [this] {
+        if (this->layoutQueued_)
+        {
+            this->layoutQueued_ = false;
+            this->actuallyLayoutMessages();
+            this->queueUpdate();
+
+            // keep coalescing while messages are coming in
+            this->layoutCooldown_->start();
+        }
+    });
 }
 
 void ChannelView::initializeLayout()
@@ -175,8 +190,16 @@ void ChannelView::initializeSignals()
     getSettings()->showLastMessageIndicator.connect(
         [this](auto, auto) { this->update(); }, this->connections_);
 
-    connections_.push_back(
-        getApp()->windows->repaintGifs.connect([&] { this->queueUpdate(); }));
+    connections_.push_back(getApp()->windows->repaintGifs.connect([&] {
+        // only views that show an animated image need to be repainted
+        if (this->animationsOnScreen_)
+            this->queueUpdate();
+    }));
+
+    connections_.push_back(getApp()->windows->imagesChanged.connect(
+        [&](const std::unordered_set<const Image *> &images) {
+            this->layoutImages(images);
+        }));
 
     connections_.push_back(
         getApp()->windows->layout.connect([&](Channel *channel) {
@@ -219,6 +242,101 @@ void ChannelView::layoutMessages()
     //    }
 }
 
+// Lays out right away if nothing was laid out within the last frame, otherwise
+// the layout is done once the frame is over. Bursts of messages end up with
+// one layout and one repaint per frame.
+void ChannelView::queueLayout()
+{
+    if (this->layoutCooldown_->isActive())
+    {
+        this->layoutQueued_ = true;
+        return;
+    }
+
+    this->actuallyLayoutMessages();
+    this->queueUpdate();
+
+    this->layoutCooldown_->start();
+}
+
+// Lays out a message and remembers which images it shows.
+bool ChannelView::layoutMessage(const MessageLayoutPtr &layout, int width,
+                                MessageElementFlags flags)
+{
+    if (!layout->layout(width, this->getScale(), flags))
+    {
+        return false;
+    }
+
+    // the images may have changed with the layout, so forget the old ones
+    this->forgetImages(layout.get());
+
+    auto &images = this->layoutImages_[layout.get()];
+    layout->forEachImage([&](const Image *image) {
+        if (this->imageLayouts_[image].insert(layout.get()).second)
+        {
+            images.push_back(image);
+        }
+    });
+
+    return true;
+}
+
+// Called whenever a message is removed from the view, so neither map keeps
+// anything for messages that are gone.
+void ChannelView::forgetImages(MessageLayout *layout)
+{
+    auto it = this->layoutImages_.find(layout);
+    if (it == this->layoutImages_.end())
+    {
+        return;
+    }
+
+    for (auto image : it->second)
+    {
+        auto layouts = this->imageLayouts_.find(image);
+        if (layouts == this->imageLayouts_.end())
+        {
+            continue;
+        }
+
+        layouts->second.erase(layout);
+        if (layouts->second.empty())
+        {
+            this->imageLayouts_.erase(layouts);
+        }
+    }
+
+    this->layoutImages_.erase(it);
+}
+
+// Only the messages showing one of the images are laid out again, the others
+// keep their layout and buffers.
+void ChannelView::layoutImages(const std::unordered_set<const Image *> &images)
+{
+    bool found = false;
+
+    for (auto image : images)
+    {
+        auto it = this->imageLayouts_.find(image);
+        if (it == this->imageLayouts_.end())
+        {
+            continue;
+        }
+
+        for (auto layout : it->second)
+        {
+            layout->flags.set(MessageLayoutFlag::RequiresLayout);
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        this->queueLayout();
+    }
+}
+
 void ChannelView::actuallyLayoutMessages(bool causedByScrollbar)
 {
     //    BenchmarkGuard benchmark("layout");
@@ -247,6 +365,9 @@ void ChannelView::actuallyLayoutMessages(bool causedByScrollbar)
 
     MessageElementFlags flags = this->getFlags();
 
+    int visibleHeight = 0;
+    int visibleCount = 0;
+
     // layout the visible messages in the view
     if (messagesSnapshot.getLength() > start)
     {
@@ -258,9 +379,11 @@ void ChannelView::actuallyLayoutMessages(bool causedByScrollbar)
             auto message = messagesSnapshot[i];
 
             redrawRequired |=
-                message->layout(layoutWidth, this->getScale(), flags);
+                this->layoutMessage(message, layoutWidth, flags);
 
             y += message->getHeight();
+            visibleHeight += message->getHeight();
+            visibleCount++;
 
             if (y >= this->height())
             {
@@ -269,22 +392,40 @@ void ChannelView::actuallyLayoutMessages(bool causedByScrollbar)
         }
     }
 
-    // layout the messages at the bottom to determine the scrollbar thumb size
+    // messages that were never laid out are guessed to be as high as the
+    // visible ones
+    int estimatedHeight = visibleCount > 0 && visibleHeight > 0
+                              ? visibleHeight / visibleCount
+                              : int(20 * this->getScale());
+
+    // determine the scrollbar thumb size from the messages at the bottom.
+    // They only have to be laid out if they are on screen, otherwise the
+    // height of their last layout is close enough. That way scrolling and
+    // resizing far up in the scrollback only lays out the visible messages.
+    bool layoutBottom = this->showingLatestMessages_;
     int h = this->height() - 8;
 
     for (int i = int(messagesSnapshot.getLength()) - 1; i >= 0; i--)
     {
-        auto *message = messagesSnapshot[i].get();
+        const auto &message = messagesSnapshot[i];
 
-        message->layout(layoutWidth, this->getScale(), flags);
+        int height;
+        if (layoutBottom)
+        {
+            this->layoutMessage(message, layoutWidth, flags);
+            height = message->getHeight();
+        }
+        else
+        {
+            height = message->getEstimatedHeight(estimatedHeight);
+        }
 
-        h -= message->getHeight();
+        h -= height;
 
         if (h < 0)
         {
             this->scrollBar_->setLargeChange(
-                (messagesSnapshot.getLength() - i) +
-                qreal(h) / message->getHeight());
+                (messagesSnapshot.getLength() - i) + qreal(h) / height);
             //            this->scrollBar.setDesiredValue(this->scrollBar.getDesiredValue());
 
             showScrollbar = true;
@@ -325,6 +466,8 @@ void ChannelView::clearMessages()
 {
     // Clear all stored messages in this chat widget
     this->messages.clear();
+    this->imageLayouts_.clear();
+    this->layoutImages_.clear();
     this->scrollBar_->clearHighlights();
 
     // Layout chat widget messages, and force an update regardless if there are
@@ -414,6 +557,60 @@ LimitedQueueSnapshot<MessageLayoutPtr> ChannelView::getMessagesSnapshot()
     return this->snapshot_;
 }
 
+// returns true if a message had to be removed at the start
+bool ChannelView::appendMessage(const MessagePtr &message)
+{
+    MessageLayoutPtr deleted;
+
+    auto messageRef = new MessageLayout(message);
+
+    if (this->lastMessageHasAlternateBackground_)
+    {
+        messageRef->flags.set(MessageLayoutFlag::AlternateBackground);
+    }
+    if (this->channel_->shouldIgnoreHighlights())
+    {
+        messageRef->flags.set(MessageLayoutFlag::IgnoreHighlights);
+    }
+    this->lastMessageHasAlternateBackground_ =
+        !this->lastMessageHasAlternateBackground_;
+
+    if (this->isPaused())
+    {
+        this->messagesAddedSinceSelectionPause_++;
+    }
+
+    if (this->channel_->getType() != Channel::Type::TwitchMentions)
+    {
+        this->scrollBar_->addHighlight(message->getScrollBarHighlight());
+    }
+
+    if (!this->messages.pushBack(MessageLayoutPtr(messageRef), deleted))
+    {
+        return false;
+    }
+
+    this->forgetImages(deleted.get());
+    return true;
+}
+
+void ChannelView::scrollAfterRemovingMessages(size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (this->scrollBar_->isAtBottom())
+    {
+        this->scrollBar_->scrollToBottom();
+    }
+    else
+    {
+        this->scrollBar_->offset(-qreal(count));
+    }
+}
+
 void ChannelView::setChannel(ChannelPtr newChannel)
 {
     if (this->channel_)
@@ -423,72 +620,68 @@ void ChannelView::setChannel(ChannelPtr newChannel)
 
     this->clearMessages();
 
+    // make sure messages that are already in the snapshot below don't get
+    // appended a second time
+    newChannel->flushAppendedMessages();
+
     // on new message
     this->channelConnections_.push_back(newChannel->messageAppended.connect(
         [this](MessagePtr &message,
                boost::optional<MessageFlags> overridingFlags) {
-            MessageLayoutPtr deleted;
-
             auto *messageFlags = &message->flags;
             if (overridingFlags)
             {
                 messageFlags = overridingFlags.get_ptr();
             }
 
-            auto messageRef = new MessageLayout(message);
-
-            if (this->lastMessageHasAlternateBackground_)
+            if (this->appendMessage(message))
             {
-                messageRef->flags.set(MessageLayoutFlag::AlternateBackground);
+                this->scrollAfterRemovingMessages(1);
             }
-            if (this->channel_->shouldIgnoreHighlights())
-            {
-                messageRef->flags.set(MessageLayoutFlag::IgnoreHighlights);
-            }
-            this->lastMessageHasAlternateBackground_ =
-                !this->lastMessageHasAlternateBackground_;
 
-            if (this->isPaused())
+            if (!messageFlags->has(MessageFlag::DoNotTriggerNotification))
             {
-                this->messagesAddedSinceSelectionPause_++;
+                this->tabHighlightRequested.invoke(
+                    messageFlags->has(MessageFlag::Highlighted)
+                        ? HighlightState::Highlighted
+                        : HighlightState::NewMessage);
             }
 
-            if (this->messages.pushBack(MessageLayoutPtr(messageRef), deleted))
-            {
-                //                if (!this->isPaused()) {
-                if (this->scrollBar_->isAtBottom())
-                {
-                    this->scrollBar_->scrollToBottom();
-                }
-                else
-                {
-                    this->scrollBar_->offset(-1);
-                }
-                //                }
-            }
+            this->messageWasAdded_ = true;
+            this->queueLayout();
+        }));
 
-            if (!messageFlags->has(MessageFlag::DoNotTriggerNotification))
+    this->channelConnections_.push_back(newChannel->messagesAppended.connect(
+        [this](std::vector<MessagePtr> &messages) {
+            size_t removed = 0;
+            bool notify = false;
+            bool highlighted = false;
+
+            for (auto &message : messages)
             {
-                if (messageFlags->has(MessageFlag::Highlighted))
+                if (this->appendMessage(message))
                 {
-                    this->tabHighlightRequested.invoke(
-                        HighlightState::Highlighted);
+                    removed++;
                 }
-                else
+
+                if (!message->flags.has(MessageFlag::DoNotTriggerNotification))
                 {
-                    this->tabHighlightRequested.invoke(
-                        HighlightState::NewMessage);
+                    notify = true;
+                    highlighted |= message->flags.has(MessageFlag::Highlighted);
                 }
             }
 
-            if (this->channel_->getType() != Channel::Type::TwitchMentions)
+            this->scrollAfterRemovingMessages(removed);
+
+            if (notify)
             {
-                this->scrollBar_->addHighlight(
-                    message->getScrollBarHighlight());
+                this->tabHighlightRequested.invoke(
+                    highlighted ? HighlightState::Highlighted
+                                : HighlightState::NewMessage);
             }
 
             this->messageWasAdded_ = true;
-            this->layoutMessages();
+            this->queueLayout();
         }));
 
     this->channelConnections_.push_back(
@@ -539,7 +732,7 @@ void ChannelView::setChannel(ChannelPtr newChannel)
             this->selection_.start.messageIndex--;
             this->selection_.end.messageIndex--;
 
-            this->layoutMessages();
+            this->queueLayout();
         }));
 
     // on message replaced
@@ -569,6 +762,7 @@ void ChannelView::setChannel(ChannelPtr newChannel)
             this->scrollBar_->replaceHighlight(
                 index, replacement->getScrollBarHighlight());
 
+            this->forgetImages(message.get());
             this->messages.replaceItem(message, newItem);
             this->layoutMessages();
         }));
@@ -588,7 +782,10 @@ void ChannelView::setChannel(ChannelPtr newChannel)
         this->lastMessageHasAlternateBackground_ =
             !this->lastMessageHasAlternateBackground_;
 
-        this->messages.pushBack(MessageLayoutPtr(messageRef), deleted);
+        if (this->messages.pushBack(MessageLayoutPtr(messageRef), deleted))
+        {
+            this->forgetImages(deleted.get());
+        }
     }
 
     this->channel_ = newChannel;
@@ -742,8 +939,15 @@ void ChannelView::drawMessages(QPainter &painter)
     int y = int(-(messagesSnapshot[start].get()->getHeight() *
                   (fmod(this->scrollBar_->getCurrentValue(), 1))));
 
-    MessageLayout *end = nullptr;
     bool windowFocused = this->window() == QApplication::activeWindow();
+    this->animationsOnScreen_ = false;
+
+#ifdef Q_OS_MACOS
+    this->bufferAtlas_.beginFrame(DRAW_WIDTH, this->height(),
+                                  painter.device()->devicePixelRatioF());
+#else
+    this->bufferAtlas_.beginFrame(DRAW_WIDTH, this->height(), 1);
+#endif
 
     for (size_t i = start; i < messagesSnapshot.getLength(); ++i)
     {
@@ -755,54 +959,19 @@ void ChannelView::drawMessages(QPainter &painter)
             isLastMessage = this->lastReadMessage_.get() == layout;
         }
 
-        layout->paint(painter, DRAW_WIDTH, y, i, this->selection_,
-                      isLastMessage, windowFocused);
+        layout->paint(painter, this->bufferAtlas_, DRAW_WIDTH, y, i,
+                      this->selection_, isLastMessage, windowFocused);
+
+        if (layout->flags.has(MessageLayoutFlag::Animated))
+            this->animationsOnScreen_ = true;
 
         y += layout->getHeight();
 
-        end = layout;
         if (y > this->height())
         {
             break;
         }
     }
-
-    if (end == nullptr)
-    {
-        return;
-    }
-
-    // remove messages that are on screen
-    // the messages that are left at the end get their buffers reset
-    for (size_t i = start; i < messagesSnapshot.getLength(); ++i)
-    {
-        auto it = this->messagesOnScreen_.find(messagesSnapshot[i]);
-        if (it != this->messagesOnScreen_.end())
-        {
-            this->messagesOnScreen_.erase(it);
-        }
-    }
-
-    // delete the message buffers that aren't on screen
-    for (const std::shared_ptr<MessageLayout> &item : this->messagesOnScreen_)
-    {
-        item->deleteBuffer();
-    }
-
-    this->messagesOnScreen_.clear();
-
-    // add all messages on screen to the map
-    for (size_t i = start; i < messagesSnapshot.getLength(); ++i)
-    {
-        std::shared_ptr<MessageLayout> layout = messagesSnapshot[i];
-
-        this->messagesOnScreen_.insert(layout);
-
-        if (layout.get() == end)
-        {
-            break;
-        }
-    }
 }
 
 void ChannelView::wheelEvent(QWheelEvent *event)
@@ -858,8 +1027,8 @@ void ChannelView::wheelEvent(QWheelEvent *event)
                 }
                 else
                 {
-                    snapshot[i - 1]->layout(this->getLayoutWidth(),
-                                            this->getScale(), this->getFlags());
+                    this->layoutMessage(snapshot[i - 1], this->getLayoutWidth(),
+                                        this->getFlags());
                     scrollFactor = 1;
                     currentScrollLeft = snapshot[i - 1]->getHeight();
                 }
@@ -892,8 +1061,8 @@ void ChannelView::wheelEvent(QWheelEvent *event)
                 }
                 else
                 {
-                    snapshot[i + 1]->layout(this->getLayoutWidth(),
-                                            this->getScale(), this->getFlags());
+                    this->layoutMessage(snapshot[i + 1], this->getLayoutWidth(),
+                                        this->getFlags());
 
                     scrollFactor = 1;
                     currentScrollLeft = snapshot[i + 1]->getHeight();
@@ -1538,12 +1707,7 @@ void ChannelView::mouseDoubleClickEvent(QMouseEvent *event)
 
 void ChannelView::hideEvent(QHideEvent *)
 {
-    for (auto &layout : this->messagesOnScreen_)
-    {
-        layout->deleteBuffer();
-    }
-
-    this->messagesOnScreen_.clear();
+    this->bufferAtlas_.clear();
 }
 
 void ChannelView::showUserInfoPopup(const QString &userName)
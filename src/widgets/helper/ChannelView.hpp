@@ -4,6 +4,7 @@
 #include "messages/LimitedQueue.hpp"
 #include "messages/LimitedQueueSnapshot.hpp"
 #include "messages/Selection.hpp"
+#include "messages/layouts/MessageBufferAtlas.hpp"
 #include "widgets/BaseWidget.hpp"
 
 #include <QPaintEvent>
@@ -13,6 +14,7 @@
 #include <QWidget>
 #include <pajlada/signals/signal.hpp>
 
+#include <unordered_map>
 #include <unordered_set>
 
 namespace chatterino {
@@ -21,6 +23,9 @@ enum class HighlightState;
 class Channel;
 using ChannelPtr = std::shared_ptr<Channel>;
 
+struct Message;
+using MessagePtr = std::shared_ptr<const Message>;
+
 class MessageLayout;
 using MessageLayoutPtr = std::shared_ptr<MessageLayout>;
 
@@ -31,6 +36,7 @@ class Scrollbar;
 class EffectLabel;
 struct Link;
 class MessageLayoutElement;
+class Image;
 
 class ChannelView final : public BaseWidget
 {
@@ -94,9 +100,13 @@ private:
     void initializeScrollbar();
     void initializeSignals();
 
-    // void messageAppended(MessagePtr &message);
-    // void messageAddedAtStart(std::vector<MessagePtr> &messages);
-    // void messageRemoveFromStart(MessagePtr &message);
+    bool appendMessage(const MessagePtr &message);
+    void scrollAfterRemovingMessages(size_t count);
+    void queueLayout();
+    bool layoutMessage(const MessageLayoutPtr &layout, int width,
+                       MessageElementFlags flags);
+    void forgetImages(MessageLayout *layout);
+    void layoutImages(const std::unordered_set<const Image *> &images);
 
     void updatePauseStatus();
     void detachChannel();
@@ -119,7 +129,7 @@ private:
     int getLayoutWidth() const;
 
     QTimer *layoutCooldown_;
-    bool layoutQueued_;
+    bool layoutQueued_ = false;
 
     QTimer updateTimer_;
     bool updateQueued_ = false;
@@ -174,7 +184,16 @@ private:
     std::vector<pajlada::Signals::ScopedConnection> connections_;
     std::vector<pajlada::Signals::ScopedConnection> channelConnections_;
 
-    std::unordered_set<std::shared_ptr<MessageLayout>> messagesOnScreen_;
+    MessageBufferAtlas bufferAtlas_;
+    bool animationsOnScreen_ = false;
+
+    // the messages each image showed up in when they were laid out, so a
+    // decoded image only lays out those again, and the other way around so
+    // removing a message only touches its own images
+    std::unordered_map<const Image *, std::unordered_set<MessageLayout *>>
+        imageLayouts_;
+    std::unordered_map<const MessageLayout *, std::vector<const Image *>>
+        layoutImages_;
 
 private slots:
     void wordFlagsChanged()
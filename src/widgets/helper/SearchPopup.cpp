@@ -2,11 +2,15 @@
 
 #include <QHBoxLayout>
 #include <QLineEdit>
+#include <QPointer>
 #include <QPushButton>
+#include <QThreadPool>
 #include <QVBoxLayout>
 
 #include "common/Channel.hpp"
+#include "common/ChannelSearchIndex.hpp"
 #include "messages/Message.hpp"
+#include "util/PostToThread.hpp"
 #include "widgets/helper/ChannelView.hpp"
 
 namespace chatterino {
@@ -17,6 +21,11 @@ SearchPopup::SearchPopup()
     this->resize(400, 600);
 }
 
+SearchPopup::~SearchPopup()
+{
+    this->cancelSearch();
+}
+
 void SearchPopup::initLayout()
 {
     // VBOX
@@ -62,7 +71,7 @@ void SearchPopup::initLayout()
 
 void SearchPopup::setChannel(ChannelPtr channel)
 {
-    this->snapshot_ = channel->getMessageSnapshot();
+    this->searchIndex_ = channel->getSearchIndex();
     this->performSearch();
 
     this->setWindowTitle("Searching in " + channel->getName() + "s history");
@@ -70,23 +79,58 @@ void SearchPopup::setChannel(ChannelPtr channel)
 
 void SearchPopup::performSearch()
 {
-    QString text = searchInput_->text();
+    this->cancelSearch();
 
     ChannelPtr channel(new Channel("search", Channel::Type::None));
+    this->channelView_->setChannel(channel);
 
-    for (size_t i = 0; i < this->snapshot_.getLength(); i++)
+    if (!this->searchIndex_)
     {
-        MessagePtr message = this->snapshot_[i];
-
-        if (text.isEmpty() ||
-            message->searchText.indexOf(this->searchInput_->text(), 0,
-                                        Qt::CaseInsensitive) != -1)
-        {
-            channel->addMessage(message);
-        }
+        return;
     }
 
-    this->channelView_->setChannel(channel);
+    auto query = ChannelSearchIndex::parseQuery(this->searchInput_->text());
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    this->searchCancelled_ = cancelled;
+
+    // the results show up as they are found. The channel must only be
+    // released on the gui thread, so the worker doesn't hold on to it.
+    std::weak_ptr<Channel> weakChannel = channel;
+
+    QThreadPool::globalInstance()->start(new LambdaRunnable(
+        [self = QPointer<SearchPopup>(this), index = this->searchIndex_,
+         query, cancelled, weakChannel] {
+            index->search(
+                query,
+                [&](std::vector<ChannelSearchIndex::WeakMessagePtr> &batch) {
+                    postToThread([self, cancelled, weakChannel, batch] {
+                        auto channel = weakChannel.lock();
+                        if (!self || *cancelled || !channel)
+                        {
+                            return;
+                        }
+
+                        // messages that are gone by now are skipped
+                        for (const auto &weakMessage : batch)
+                        {
+                            if (auto message = weakMessage.lock())
+                            {
+                                channel->addMessage(message);
+                            }
+                        }
+                    });
+
+                    return !*cancelled;
+                });
+        }));
+}
+
+void SearchPopup::cancelSearch()
+{
+    if (this->searchCancelled_)
+    {
+        *this->searchCancelled_ = true;
+    }
 }
 
 }  // namespace chatterino
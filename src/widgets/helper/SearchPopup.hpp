@@ -1,8 +1,8 @@
 #pragma once
 
-#include "messages/LimitedQueueSnapshot.hpp"
 #include "widgets/BaseWindow.hpp"
 
+#include <atomic>
 #include <memory>
 
 class QLineEdit;
@@ -11,6 +11,7 @@ namespace chatterino {
 
 class Channel;
 class ChannelView;
+class ChannelSearchIndex;
 
 struct Message;
 using MessagePtr = std::shared_ptr<const Message>;
@@ -19,14 +20,17 @@ class SearchPopup : public BaseWindow
 {
 public:
     SearchPopup();
+    ~SearchPopup() override;
 
     void setChannel(std::shared_ptr<Channel> channel);
 
 private:
     void initLayout();
     void performSearch();
+    void cancelSearch();
 
-    LimitedQueueSnapshot<MessagePtr> snapshot_;
+    std::shared_ptr<ChannelSearchIndex> searchIndex_;
+    std::shared_ptr<std::atomic<bool>> searchCancelled_;
     QLineEdit *searchInput_;
     ChannelView *channelView_;
 };